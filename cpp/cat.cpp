@@ -36,16 +36,12 @@ CAT::CAT(string filename) {
   string BitIndexName;
 
   // initialize the global tables with trivial entries
-  CollTable.resize(0);
-  AttTable.resize(0);
+  CollTable.clear();
+  AttTable.clear();
   AttCollTable.resize(0);
-  IndTable.resize(0);
-  BitIndTable.resize(0);
-  CollTable.push_back("");
-  AttTable.push_back("");
+  IndTable.clear();
+  BitIndTable.clear();
   AttCollTable.push_back(0);
-  IndTable.push_back("");
-  BitIndTable.push_back("");  // 632
 
   if ((fp = fopen(filename.c_str(), "r")) == NULL) OUTPUT_ERROR("can not open file 'catalog'");
 
@@ -276,7 +272,7 @@ CAT::CAT(string filename) {
 
   // translate foreign key string to foreignkey
   for (int CollId = 1; CollId < CollProps.size(); CollId++) {
-    CollName = CollTable[CollId];
+    CollName = GetCollName(CollId);
     CollProp = CollProps[CollId];
     if (CollProp->ForeignKeyString.size() > 0) {
       for (int keyNum = 0; keyNum < CollProp->ForeignKeyString.size(); keyNum++) {
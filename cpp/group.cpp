@@ -2,14 +2,20 @@
 #include "../header/stdafx.h"
 
 Group::Group(MExression *MExpr)
-    : GroupID(MExpr->GetGrpID()), FirstLogMExpr(MExpr), LastLogMExpr(MExpr), FirstPhysMExpr(NULL), LastPhysMExpr(NULL) {
+    : GroupID(MExpr->GetGrpID()),
+      FirstLogMExpr(MExpr),
+      LastLogMExpr(MExpr),
+      FirstPhysMExpr(NULL),
+      LastPhysMExpr(NULL),
+      FirstEntry(NULL),
+      LastEntry(NULL) {
   init_state();
 
-  // find the log prop
+  // find the log prop, shared with the groups which have an equal one
   int arity = MExpr->GetArity();
   LOG_PROP **InputProp = NULL;
   if (arity == 0) {
-    LogProp = (MExpr->GetOp())->FindLogProp(InputProp);
+    LogProp = Ssp->LogProps.Intern((MExpr->GetOp())->FindLogProp(InputProp));
   } else {
     InputProp = new LOG_PROP *[arity];
     Group *group;
@@ -18,7 +24,7 @@ Group::Group(MExression *MExpr)
       InputProp[i] = group->LogProp;
     }
 
-    LogProp = ((MExpr->GetOp())->FindLogProp(InputProp));
+    LogProp = Ssp->LogProps.Intern((MExpr->GetOp())->FindLogProp(InputProp));
 
     delete[] InputProp;
   }
@@ -32,7 +38,7 @@ Group::Group(MExression *MExpr)
   */
   double cost = 0;
   if (MExpr->GetOp()->is_logical()) {
-    if (MExpr->GetOp()->GetName() == ("GET"))
+    if (MExpr->GetOp()->GetOpcode() == OPCODE::GET)
       cost = 0;  // Since GET operator does not have a CopyOut cost
     else
       cost = TouchCopyCost((LOG_COLL_PROP *)LogProp);
@@ -41,11 +47,11 @@ Group::Group(MExression *MExpr)
     if (CuCardPruning) cost += FetchingCost((LOG_COLL_PROP *)LogProp);
   }
 
-  LowerBd = new Cost(cost);
+  LowerBd = Cost(cost);
 
   /* if the operator is EQJOIN with m tables, estimate group size
      is 2^m*2.5. else it is zero */
-  if (MExpr->GetOp()->GetName() == ("EQJOIN")) {
+  if (MExpr->GetOp()->GetOpcode() == OPCODE::EQJOIN) {
     int NumTables = this->EstimateNumTables(MExpr);
     EstiGrpSize = pow(2, NumTables) * 2.5;
   } else
@@ -53,7 +59,7 @@ Group::Group(MExression *MExpr)
 
   // the initial value is -1, meaning no winner has been found
   count = -1;
-  if (COVETrace) {
+  if (TRACING(TRACE_COVE)) {
     string os;
     if (arity) {
       for (int i = 0; i < arity; i++) {
@@ -62,15 +68,17 @@ Group::Group(MExression *MExpr)
       }
     }
 
-    OutputCOVE << "\taddGroup { " << GroupID << " " << MExpr << " [ " << MExpr->GetOp()->Dump() << "  " << os << " ]} "
-               << LogProp->DumpCOVE() << endl;
+    COVE("\taddGroup { " << GroupID << " " << MExpr << " [ " << MExpr->GetOp()->Dump() << "  " << os << " ]} "
+                         << LogProp->DumpCOVE());
   }
 }
 
+void *Group::CIRCLE_ENTRY::operator new(size_t size) { return Ssp->GetArena().alloc(size); }
+
+void Group::CIRCLE_ENTRY::operator delete(void *p, size_t size) { Ssp->GetArena().free(p, size); }
+
 // free up memory
 Group::~Group() {
-  delete LogProp;
-  delete LowerBd;
 
   MExression *mexpr = FirstLogMExpr;
   MExression *next = mexpr;
@@ -88,7 +96,13 @@ Group::~Group() {
     mexpr = next;
   }
 
-  for (int i = 0; i < Winners.size(); i++) delete Winners[i];
+  CIRCLE_ENTRY *Entry = FirstEntry;
+  while (Entry != NULL) {
+    CIRCLE_ENTRY *Next = Entry->Next;
+    delete Entry->Winner;
+    delete Entry;
+    Entry = Next;
+  }
 }
 
 // estimate the number of tables in EQJOIN
@@ -100,7 +114,7 @@ int Group::EstimateNumTables(MExression *MExpr) {
   // if the input is EQJOIN, continue to count all the input
   for (int i = 0; i < arity; i++) {
     group = Ssp->GetGroup(MExpr->GetInput(i));
-    if (group->GetFirstLogMExpr()->GetOp()->GetName() == ("EQJOIN")) {
+    if (group->GetFirstLogMExpr()->GetOp()->GetOpcode() == OPCODE::EQJOIN) {
       table_num = group->EstimateNumTables(group->GetFirstLogMExpr());
     } else
       table_num = 1;
@@ -110,6 +124,8 @@ int Group::EstimateNumTables(MExression *MExpr) {
 }
 
 void Group::NewMExpr(MExression *MExpr) {
+  lock_guard<recursive_mutex> guard(Lock);
+
   // link to last mexpr
   if (MExpr->GetOp()->is_logical()) {
     LastLogMExpr->SetNextMExpr(MExpr);
@@ -125,7 +141,7 @@ void Group::NewMExpr(MExression *MExpr) {
 
   // if there is a winner found before, count the number of plans
   if (count != -1) count++;
-  if (COVETrace)  // New MExpr
+  if (TRACING(TRACE_COVE))  // New MExpr
   {
     string os;
     int arity = MExpr->GetArity();
@@ -137,9 +153,119 @@ void Group::NewMExpr(MExression *MExpr) {
     }
     os += " ";
 
-    OutputCOVE << "\taddExp { " << GroupID << " " << MExpr << " [ " << MExpr->GetOp()->Dump() << " " << os << " ]} "
-               << LogProp->DumpCOVE() << endl;
+    COVE("\taddExp { " << GroupID << " " << MExpr << " [ " << MExpr->GetOp()->Dump() << " " << os << " ]} "
+                       << LogProp->DumpCOVE());
+  }
+}
+
+void Group::NewParent(MExression *MExpr) {
+  lock_guard<recursive_mutex> guard(Lock);
+  Parents.push_back(MExpr);
+}
+
+void Group::Merge(Group *From, vector<OptimizerTask *> &Woken) {
+  lock_guard<recursive_mutex> guard(Lock);
+
+  // link From's lists to the end of mine
+  MExression *MExpr;
+  for (MExpr = From->FirstLogMExpr; MExpr != NULL; MExpr = MExpr->GetNextMExpr()) MExpr->SetGrpID(GroupID);
+  for (MExpr = From->FirstPhysMExpr; MExpr != NULL; MExpr = MExpr->GetNextMExpr()) MExpr->SetGrpID(GroupID);
+
+  LastLogMExpr->SetNextMExpr(From->FirstLogMExpr);
+  LastLogMExpr = From->LastLogMExpr;
+  if (From->FirstPhysMExpr) {
+    if (LastPhysMExpr)
+      LastPhysMExpr->SetNextMExpr(From->FirstPhysMExpr);
+    else
+      FirstPhysMExpr = From->FirstPhysMExpr.load();
+    LastPhysMExpr = From->LastPhysMExpr;
   }
+  From->FirstLogMExpr = From->LastLogMExpr = NULL;
+  From->FirstPhysMExpr = From->LastPhysMExpr = NULL;
+
+  // The groups are equivalent, so a complete search of either one found the
+  // cheapest plan of both.  Keep the cheaper winner for each property.
+  CIRCLE_ENTRY *Kept = NULL;  // From's entries which stay with From, holding its winners
+  CIRCLE_ENTRY *Next;
+  for (CIRCLE_ENTRY *Entry = From->FirstEntry; Entry != NULL; Entry = Next) {
+    Next = Entry->Next;
+    CIRCLE_ENTRY *Mine = GetEntry(Entry->PropId);
+
+    // never searched here, take the entry with its search and waiters
+    if (!Mine) {
+      Entry->Next = NULL;
+      if (LastEntry)
+        LastEntry->Next = Entry;
+      else
+        FirstEntry = Entry;
+      LastEntry = Entry;
+      continue;
+    }
+
+    // A done winner with a plan holds the cheapest plan of both groups.  One
+    // without a plan only tells that no plan is cheaper than its cost, so a
+    // search still running on the other group has to complete.
+    WINNER *Winner = Entry->Winner;
+    WINNER *MyWinner = Mine->Winner;
+    bool done = (Winner->GetDone() && (Winner->GetMPlan() || MyWinner->GetDone())) ||
+                (MyWinner->GetDone() && MyWinner->GetMPlan());
+    WINNER *Better = MyWinner;
+    if (Winner->GetMPlan() && (!MyWinner->GetMPlan() || Winner->GetCost() < MyWinner->GetCost()))
+      Better = Winner;
+    if (Better != MyWinner || done != MyWinner->GetDone()) {
+      Mine->Winner = new WINNER(Better->GetMPlan(), Mine->PhysProp, Better->GetCost(), done, MyWinner);
+    }
+
+    // the searches still running will mark the winner done and wake the waiters
+    if (done) {
+      Woken.insert(Woken.end(), Mine->Waiters.begin(), Mine->Waiters.end());
+      Woken.insert(Woken.end(), Entry->Waiters.begin(), Entry->Waiters.end());
+      Mine->Waiters.clear();
+    } else
+      Mine->Waiters.insert(Mine->Waiters.end(), Entry->Waiters.begin(), Entry->Waiters.end());
+    Entry->Waiters.clear();
+
+    Entry->Next = Kept;
+    Kept = Entry;
+  }
+  From->FirstEntry = Kept;
+  From->LastEntry = NULL;
+
+  // either group explored or optimized has generated all the expressions of both
+  State.explored = State.explored || From->State.explored;
+  State.optimized = State.optimized || From->State.optimized;
+  State.exploring = State.exploring || From->State.exploring;
+  State.enumerated = State.enumerated || From->State.enumerated;
+  if (State.explored || State.optimized) {
+    Woken.insert(Woken.end(), ExploreWaiters.begin(), ExploreWaiters.end());
+    Woken.insert(Woken.end(), From->ExploreWaiters.begin(), From->ExploreWaiters.end());
+    ExploreWaiters.clear();
+  } else
+    ExploreWaiters.insert(ExploreWaiters.end(), From->ExploreWaiters.begin(), From->ExploreWaiters.end());
+  From->ExploreWaiters.clear();
+  set_changed(true);
+
+  Parents.insert(Parents.end(), From->Parents.begin(), From->Parents.end());
+  From->Parents.clear();
+  MergedIDs.push_back(From->GroupID);
+  MergedIDs.insert(MergedIDs.end(), From->MergedIDs.begin(), From->MergedIDs.end());
+}
+
+void Group::DropLogMExpr(MExression *MExpr) {
+  lock_guard<recursive_mutex> guard(Lock);
+
+  MExression *Prev = NULL;
+  for (MExression *LogMExpr = FirstLogMExpr; LogMExpr != MExpr; LogMExpr = LogMExpr->GetNextMExpr()) {
+    assert(LogMExpr);
+    Prev = LogMExpr;
+  }
+
+  if (Prev)
+    Prev->SetNextMExpr(MExpr->GetNextMExpr());
+  else
+    FirstLogMExpr = MExpr->GetNextMExpr();
+  if (LastLogMExpr == MExpr) LastLogMExpr = Prev;
+  MExpr->SetNextMExpr(NULL);
 }
 
 void Group::set_optimized(bool is_optimized) {
@@ -209,22 +335,22 @@ string Group::Dump(bool dumpexpr) {
   // Print Winner's circle
   os += "Winners:\n";
 
-  Size = Winners.size();
   PHYS_PROP *PhysProp;
-  if (!Size) os += "\tNo Winners\n";
-  for (int i = 0; i < Size; i++) {
-    PhysProp = Winners[i]->GetPhysProp();
+  if (!FirstEntry) os += "\tNo Winners\n";
+  for (CIRCLE_ENTRY *Entry = FirstEntry; Entry != NULL; Entry = Entry->Next) {
+    WINNER *Winner = Entry->Winner;
+    PhysProp = Winner->GetPhysProp();
     os += "\t";
     os += PhysProp->Dump();
     os += ", ";
-    os += (Winners[i]->GetMPlan() ? Winners[i]->GetMPlan()->Dump() : "NULL Plan");
+    os += (Winner->GetMPlan() ? Winner->GetMPlan()->Dump() : "NULL Plan");
     os += ", ";
-    os += (Winners[i]->GetCost() ? Winners[i]->GetCost()->Dump() : "NULL Cost");
+    os += Winner->GetCost().Dump();
     os += ", ";
-    os += (Winners[i]->GetDone() ? "Done" : "Not done");
+    os += (Winner->GetDone() ? "Done" : "Not done");
     os += "\n";
   }
-  os += "LowerBound: " + LowerBd->Dump() + "\n";
+  os += "LowerBound: " + LowerBd.Dump() + "\n";
 
   os += "log_prop: ";
   os += (*LogProp).Dump();
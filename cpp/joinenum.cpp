@@ -0,0 +1,379 @@
+// joinenum.cpp - implementation of class JoinEnumerator
+
+#include "../header/joinenum.h"
+
+#include "../header/physop.h"
+#include "../header/rules.h"
+#include "../header/stdafx.h"
+
+void JoinEnumerator::EnumerateAll(int GrpID) {
+  MExression *MExpr = Ssp->GetGroup(GrpID)->GetFirstLogMExpr();
+
+  if (MExpr->GetOp()->GetOpcode() == OPCODE::EQJOIN) {
+    JoinEnumerator Block;
+    if (Block.Enumerate(GrpID)) {
+      // blocks further down start below the relations of this one
+      for (auto &&relation : Block.Relations) EnumerateAll(relation);
+      return;
+    }
+  }
+
+  for (int i = 0; i < MExpr->GetArity(); i++) EnumerateAll(MExpr->GetInput(i));
+}
+
+JoinEnumerator::~JoinEnumerator() {
+  for (auto &&prop : Props) delete prop.second;
+}
+
+bool JoinEnumerator::Reorders(int RuleNo) {
+  return RuleNo == R_EQJOIN_COMMUTE || RuleNo == R_EQJOIN_LTOR || RuleNo == R_EQJOIN_RTOL || RuleNo == R_EXCHANGE;
+}
+
+bool JoinEnumerator::Enumerate(int GrpID) {
+  SET All = Collect(GrpID);
+  if (Relations.size() > MAX_JOIN_RELATIONS || !Connect()) {
+    PTRACE("join block of group " << GrpID << " is left to the rules");
+    return false;
+  }
+
+  int n = Relations.size();
+  if (JoinEnum == JOIN_RANDOM) {
+    if (!Randomized(GrpID)) return false;
+    if (DeadlineMs <= 0) Enumerated();
+  } else if (JoinEnum == JOIN_GOO || (GooThreshold > 0 && n > GooThreshold)) {
+    Greedy();
+    OptStat->GooJoins += Pairs;
+    if (DeadlineMs <= 0) Enumerated();
+  } else if (JoinEnum == JOIN_DPCCP) {
+    DPccp();
+    OptStat->DPPairs += Pairs;
+    Enumerated();
+  } else {
+    // the rules order the block, but blocks below its relations may still be large
+    return true;
+  }
+  assert(Groups[All] == GrpID);
+
+  PTRACE("join block of group " << GrpID << ": " << n << " relations, " << Groups.size() << " groups, " << Pairs
+                                 << " joins");
+  return true;
+}
+
+JoinEnumerator::SET JoinEnumerator::Collect(int GrpID) {
+  MExression *MExpr = Ssp->GetGroup(GrpID)->GetFirstLogMExpr();
+  SET S;
+
+  if (MExpr->GetOp()->GetOpcode() == OPCODE::EQJOIN && Relations.size() <= MAX_JOIN_RELATIONS) {
+    Joins.push_back((EQJOIN *)MExpr->GetOp());
+    S = Collect(MExpr->GetInput(0)) | Collect(MExpr->GetInput(1));
+  } else {
+    S = (Relations.size() < MAX_JOIN_RELATIONS) ? (SET)1 << Relations.size() : 0;
+    Relations.push_back(GrpID);
+  }
+
+  Groups[S] = GrpID;
+  return S;
+}
+
+bool JoinEnumerator::Connect() {
+  Neighbors.assign(Relations.size(), 0);
+  for (auto &&join : Joins)
+    for (int i = 0; i < join->size; i++) {
+      PREDICATE Pred = {join->lattrs[i], join->rattrs[i], Relation(join->lattrs[i]), Relation(join->rattrs[i])};
+      if (Pred.Left < 0 || Pred.Right < 0 || Pred.Left == Pred.Right) return false;
+      Predicates.push_back(Pred);
+      Neighbors[Pred.Left] |= (SET)1 << Pred.Right;
+      Neighbors[Pred.Right] |= (SET)1 << Pred.Left;
+    }
+  return true;
+}
+
+int JoinEnumerator::Relation(int AttId) {
+  for (int i = 0; i < Relations.size(); i++)
+    if (((LOG_COLL_PROP *)Ssp->GetGroup(Relations[i])->get_log_prop())->schema->InSchema(AttId)) return i;
+  return -1;
+}
+
+JoinEnumerator::SET JoinEnumerator::Neighborhood(SET S, SET X) {
+  SET N = 0;
+  for (SET Rest = S; Rest; Rest &= Rest - 1) N |= Neighbors[__builtin_ctzll(Rest)];
+  return N & ~(S | X);
+}
+
+void JoinEnumerator::DPccp() {
+  for (int i = Relations.size(); --i >= 0;) {
+    SET V = (SET)1 << i;
+    EmitCsg(V);
+    EnumerateCsgRec(V, Below(i));
+  }
+}
+
+// Subsets of N are visited in increasing order, so each comes after its own subsets.
+void JoinEnumerator::EnumerateCsgRec(SET S1, SET X) {
+  SET N = Neighborhood(S1, X);
+  if (!N) return;
+
+  for (SET Sub = (0 - N) & N; Sub; Sub = (Sub - N) & N) EmitCsg(S1 | Sub);
+  for (SET Sub = (0 - N) & N; Sub; Sub = (Sub - N) & N) EnumerateCsgRec(S1 | Sub, X | N);
+}
+
+void JoinEnumerator::EmitCsg(SET S1) {
+  SET X = S1 | Below(__builtin_ctzll(S1));
+  SET N = Neighborhood(S1, X);
+
+  // each neighbor in turn, from the highest index down, starts a complement
+  for (int i = 63; i >= 0; i--) {
+    SET V = (SET)1 << i;
+    if (!(N & V)) continue;
+    EmitCsgCmp(S1, V);
+    EnumerateCmpRec(S1, V, X | (Below(i) & N));
+  }
+}
+
+void JoinEnumerator::EnumerateCmpRec(SET S1, SET S2, SET X) {
+  SET N = Neighborhood(S2, X);
+  if (!N) return;
+
+  // S2 is joined to S1, and so is every set containing it
+  for (SET Sub = (0 - N) & N; Sub; Sub = (Sub - N) & N) EmitCsgCmp(S1, S2 | Sub);
+  for (SET Sub = (0 - N) & N; Sub; Sub = (Sub - N) & N) EnumerateCmpRec(S1, S2 | Sub, X | N);
+}
+
+void JoinEnumerator::EmitCsgCmp(SET S1, SET S2) {
+  Pairs++;
+  Join(S1, S2);
+  Join(S2, S1);
+}
+
+void JoinEnumerator::Greedy() {
+  vector<SET> Trees;
+  for (int i = 0; i < Relations.size(); i++) Trees.push_back((SET)1 << i);
+
+  while (Trees.size() > 1) {
+    // the connected pair of trees with the smallest join
+    int Left = -1, Right = -1;
+    float MinCard = 0;
+    for (int i = 0; i < Trees.size(); i++)
+      for (int j = i + 1; j < Trees.size(); j++) {
+        if (!(Neighborhood(Trees[i], 0) & Trees[j])) continue;
+        float Card = JoinCard(Trees[i], Trees[j]);
+        if (Left < 0 || Card < MinCard) {
+          Left = i;
+          Right = j;
+          MinCard = Card;
+        }
+      }
+    if (Left < 0) break;  // the rest is not connected
+
+    EmitCsgCmp(Trees[Left], Trees[Right]);
+    Trees[Left] |= Trees[Right];
+    Trees.erase(Trees.begin() + Right);
+  }
+}
+
+void JoinEnumerator::Enumerated() {
+  for (auto &&group : Groups)
+    if (group.first & (group.first - 1)) Ssp->GetGroup(group.second)->set_enumerated(true);
+}
+
+EQJOIN *JoinEnumerator::MakeJoin(SET Left, SET Right) {
+  // the predicates between the two sides, oriented from Left to Right
+  int Size = 0;
+  int *LeftAtts = new int[Predicates.size()];
+  int *RightAtts = new int[Predicates.size()];
+  for (auto &&Pred : Predicates) {
+    if ((Left >> Pred.Left & 1) && (Right >> Pred.Right & 1)) {
+      LeftAtts[Size] = Pred.LeftAtt;
+      RightAtts[Size++] = Pred.RightAtt;
+    } else if ((Left >> Pred.Right & 1) && (Right >> Pred.Left & 1)) {
+      LeftAtts[Size] = Pred.RightAtt;
+      RightAtts[Size++] = Pred.LeftAtt;
+    }
+  }
+  assert(Size > 0);
+
+  return new EQJOIN(LeftAtts, RightAtts, Size);
+}
+
+float JoinEnumerator::JoinCard(SET Left, SET Right) {
+  EQJOIN *Op = MakeJoin(Left, Right);
+  LOG_PROP *Inputs[2] = {Ssp->GetGroup(Groups[Left])->get_log_prop(), Ssp->GetGroup(Groups[Right])->get_log_prop()};
+  LOG_PROP *Prop = Op->FindLogProp(Inputs);
+  float Card = ((LOG_COLL_PROP *)Prop)->Card;
+  delete Prop;
+  delete Op;
+  return Card;
+}
+
+void JoinEnumerator::Join(SET Left, SET Right) {
+  assert(Groups.count(Left) && Groups.count(Right));
+
+  Expression Expr(MakeJoin(Left, Right), {new Expression(new LeafOperator(0, Groups[Left]), {}),
+                                          new Expression(new LeafOperator(1, Groups[Right]), {})});
+  auto Found = Groups.find(Left | Right);
+  int GrpID = (Found == Groups.end()) ? NEW_GRPID : Found->second;
+  MExression *MExpr = Ssp->CopyIn(&Expr, GrpID);
+  if (MExpr && MExpr->GetGrpID() == GrpID) Memo_M_Exprs++;
+  Groups[Left | Right] = GrpID;
+}
+
+LOG_PROP *JoinEnumerator::Prop(SET S) {
+  auto Found = Groups.find(S);
+  if (Found != Groups.end()) return Ssp->GetGroup(Found->second)->get_log_prop();
+  assert(Props.count(S));
+  return Props[S];
+}
+
+LOG_PROP *JoinEnumerator::JoinProp(SET Left, SET Right) {
+  if (Groups.count(Left | Right)) return Prop(Left | Right);
+
+  // the first split of a set estimates it, as the first mexpr of a group does
+  LOG_PROP *&JoinProp = Props[Left | Right];
+  if (!JoinProp) {
+    EQJOIN *Op = MakeJoin(Left, Right);
+    LOG_PROP *Inputs[2] = {Prop(Left), Prop(Right)};
+    JoinProp = Op->FindLogProp(Inputs);
+    delete Op;
+  }
+  return JoinProp;
+}
+
+int JoinEnumerator::Original(int GrpID, TREE &Tree, int &NextRelation) {
+  MExression *MExpr = Ssp->GetGroup(GrpID)->GetFirstLogMExpr();
+  if (MExpr->GetOp()->GetOpcode() != OPCODE::EQJOIN) return NextRelation++;
+
+  int Left = Original(MExpr->GetInput(0), Tree, NextRelation);
+  int Right = Original(MExpr->GetInput(1), Tree, NextRelation);
+  Tree.push_back({Left, Right});
+  return Tree.size() - 1;
+}
+
+double JoinEnumerator::TreeCost(TREE &Tree, int Node, SET &S) {
+  if (Tree[Node].Left < 0) {
+    S = (SET)1 << Node;
+    return 0;
+  }
+
+  SET Left, Right;
+  double Total = TreeCost(Tree, Tree[Node].Left, Left) + TreeCost(Tree, Tree[Node].Right, Right);
+  S = Left | Right;
+  if (Total == HUGE_VAL || !(Neighborhood(Left, 0) & Right)) return HUGE_VAL;
+
+  auto Found = LocalCosts.find(make_pair(Left, Right));
+  if (Found != LocalCosts.end()) return Total + Found->second;
+
+  EQJOIN *Op = MakeJoin(Left, Right);
+  HASH_JOIN Hash(CopyArray(Op->lattrs, Op->size), CopyArray(Op->rattrs, Op->size), Op->size);
+  LOG_PROP *Inputs[2] = {Prop(Left), Prop(Right)};
+  double Local = Hash.FindLocalCost(JoinProp(Left, Right), Inputs).GetValue();
+  delete Op;
+
+  LocalCosts[make_pair(Left, Right)] = Local;
+  return Total + Local;
+}
+
+bool JoinEnumerator::Move(TREE &Tree) {
+  int n = Relations.size();
+  NODE &Join = Tree[n + Random() % (n - 1)];
+  int Left = Join.Left, Right = Join.Right;
+  bool LeftJoin = Tree[Left].Left >= 0, RightJoin = Tree[Right].Left >= 0;
+
+  switch (Random() % 6) {
+    case 0:  // EQJOIN_COMMUTE: A B -> B A
+      swap(Join.Left, Join.Right);
+      return true;
+    case 1:  // EQJOIN_LTOR: (A B) C -> A (B C)
+      if (!LeftJoin) return false;
+      Join.Left = Tree[Left].Left;
+      Tree[Left] = {Tree[Left].Right, Right};
+      Join.Right = Left;
+      return true;
+    case 2:  // EQJOIN_RTOL: A (B C) -> (A B) C
+      if (!RightJoin) return false;
+      Join.Right = Tree[Right].Right;
+      Tree[Right] = {Left, Tree[Right].Left};
+      Join.Left = Right;
+      return true;
+    case 3:  // EXCHANGE: (A B) (C D) -> (A C) (B D)
+      if (!LeftJoin || !RightJoin) return false;
+      swap(Tree[Left].Right, Tree[Right].Left);
+      return true;
+    // The join exchanges reorder a star, where the moves above must pass through a Cartesian product
+    case 4:  // (A B) C -> (A C) B, EQJOIN_LTOR then EQJOIN_COMMUTE and EQJOIN_RTOL
+      if (!LeftJoin) return false;
+      swap(Tree[Left].Right, Join.Right);
+      return true;
+    default:  // A (B C) -> B (A C), EQJOIN_RTOL then EQJOIN_COMMUTE and EQJOIN_LTOR
+      if (!RightJoin) return false;
+      swap(Join.Left, Tree[Right].Left);
+      return true;
+  }
+}
+
+bool JoinEnumerator::Randomized(int GrpID) {
+  int n = Relations.size();
+  TREE Tree(n, NODE{-1, -1});
+  int NextRelation = 0;
+  int Root = Original(GrpID, Tree, NextRelation);
+
+  SET All;
+  double Current = TreeCost(Tree, Root, All);
+  double QueryCost = Current;
+  TREE Best = Tree;
+  double BestCost = Current;
+
+  // iterative improvement until a local minimum, then simulated annealing until frozen, then again from the
+  // best tree until the moves or the time run out
+  auto Start = chrono::steady_clock::now();
+  double Temperature = 0;
+  int Failed = 0, Stage = 0;
+  uniform_real_distribution<double> Uniform(0, 1);
+  for (int Moves = 0; Moves < RandomMaxMoves; Moves++) {
+    if (RandomMaxMs > 0 && !(Moves & 63) && chrono::steady_clock::now() - Start >= chrono::milliseconds(RandomMaxMs))
+      break;
+
+    TREE Candidate = Tree;
+    if (!Move(Candidate)) continue;
+    OptStat->RandomMoves++;
+    double CandidateCost = TreeCost(Candidate, Root, All);
+
+    double Delta = CandidateCost - Current;
+    if (Delta < 0 || (Temperature > 0 && CandidateCost != HUGE_VAL && Uniform(Random) < exp(-Delta / Temperature))) {
+      Tree.swap(Candidate);
+      Current = CandidateCost;
+      Failed = 0;
+      if (Current < BestCost) {
+        Best = Tree;
+        BestCost = Current;
+      }
+    } else if (Temperature == 0 && Current != HUGE_VAL && ++Failed >= LOCAL_MINIMUM * n) {
+      PTRACE("randomized join search: local minimum " << Current << " after " << Moves << " moves");
+      Temperature = START_TEMPERATURE * Current;
+    }
+
+    if (Temperature > 0 && ++Stage == n) {
+      Stage = 0;
+      Temperature *= COOLING;
+      if (Temperature < FROZEN * BestCost) {
+        Tree = Best;
+        Current = BestCost;
+        Temperature = 0;
+        Failed = 0;
+      }
+    }
+  }
+
+  if (BestCost == HUGE_VAL) return false;  // every tree found has a Cartesian product
+  PTRACE("randomized join search: cost " << BestCost << ", the query's tree costs " << QueryCost);
+  CopyTree(Best, Root);
+  return true;
+}
+
+JoinEnumerator::SET JoinEnumerator::CopyTree(TREE &Tree, int Node) {
+  if (Tree[Node].Left < 0) return (SET)1 << Node;
+
+  SET Left = CopyTree(Tree, Tree[Node].Left);
+  SET Right = CopyTree(Tree, Tree[Node].Right);
+  EmitCsgCmp(Left, Right);
+  return Left | Right;
+}
@@ -8,9 +8,7 @@
 
 /*********** GET functions ****************/
 //##ModelId=3B0C087301FB
-GET::GET(int collId) : CollId(collId) {
-  name = GetName() + GetCollName(CollId);  // for debug
-};
+GET::GET(int collId) : CollId(collId){};
 
 GET::GET(string collection, string rangeVar) {
   RangeVar = rangeVar;
@@ -79,13 +77,9 @@ GET::GET(string collection, string rangeVar) {
     Cat->AddColl(RangeVar, collp);
     PTRACE("Catalog content after fixing CollId-based tables:" << endl << Cat->Dump());
   }
-
-  name = GetName() + GetCollName(CollId);  // for debug
 }
 
-GET::GET(GET &Op) : CollId(Op.GetCollection()) {
-  name = Op.name;  // for debug
-}
+GET::GET(GET &Op) : CollId(Op.GetCollection()) {}
 
 string GET::Dump() { return GetName() + "(" + GetCollName(CollId) + ")"; }
 
@@ -103,30 +97,17 @@ LOG_PROP *GET::FindLogProp(LOG_PROP **input) {
 
   Schema *schema = new Schema(Size);
   schema->TableNum = 1;
-  schema->TableId = new int;
+  schema->TableId = new int[1];
   schema->TableId[0] = CollId;
 
-  Attribute *Attr;
   int i;
-  for (i = 0; i < Size; i++) {
-    Attr = new Attribute(*Cat->GetAttr((*AttrNames)[i]));
-    assert(Attr != NULL);
-    // Attr = new Attribute((*AttrNames)[i], AttProp->CuCard);
-    schema->AddAttr(i, Attr);
-  }
+  for (i = 0; i < Size; i++) schema->AddAttr(i, *Cat->GetAttr((*AttrNames)[i]));
 
-  KEYS_SET *cand_key;
-  int cand_key_size = CollProp->CandidateKey->GetSize();
-  int *temp_key = CollProp->CandidateKey->CopyOut();
-  cand_key = new KEYS_SET(temp_key, cand_key_size);
-  delete[] temp_key;
+  KEYS_SET *cand_key = new KEYS_SET(*CollProp->CandidateKey);
 
   LOG_COLL_PROP *result = new LOG_COLL_PROP(CollProp->Card, CollProp->UCard, schema, cand_key);
-  // copy the foreign key info from catalog
-  for (i = 0; i < CollProp->FKeyArray.size(); i++) {
-    FOREIGN_KEY *fk = new FOREIGN_KEY(*CollProp->FKeyArray[i]);
-    result->FKeyList.push_back(fk);
-  }
+  // the foreign keys of the catalog
+  result->FKeyList = CollProp->FKeyArray;
 
   return result;
 }
@@ -134,18 +115,14 @@ LOG_PROP *GET::FindLogProp(LOG_PROP **input) {
 ub4 GET::hash() {
   ub4 hashval = GetInitval();
   hashval = lookup2(CollId, hashval);
-  return (hashval % (HtblSize - 1));
+  return hashval;
 }
 
 /*********** EQJOIN functions ****************/
-EQJOIN::EQJOIN(int *lattrs, int *rattrs, int size) : lattrs(lattrs), rattrs(rattrs), size(size) {
-  name = GetName();  // for debug
-};
+EQJOIN::EQJOIN(int *lattrs, int *rattrs, int size) : lattrs(lattrs), rattrs(rattrs), size(size){};
 
 EQJOIN::EQJOIN(EQJOIN &Op)
-    : lattrs(CopyArray(Op.lattrs, Op.size)), rattrs(CopyArray(Op.rattrs, Op.size)), size(Op.size) {
-  name = Op.name;  // for debug
-};
+    : lattrs(CopyArray(Op.lattrs, Op.size)), rattrs(CopyArray(Op.rattrs, Op.size)), size(Op.size){};
 
 string EQJOIN::Dump() {
   string os;
@@ -313,34 +290,18 @@ LOG_PROP *EQJOIN::FindLogProp(LOG_PROP **input) {
 
   // the candidate key is the merge of two candidate keys from the inputs
   KEYS_SET *cand_key;
-  if (IsFKJoin) {
-    if (LeftFK) {
-      int *temp_key = Left->CandidateKey->CopyOut();
-      cand_key = new KEYS_SET(temp_key, Left->CandidateKey->GetSize());
-      delete[] temp_key;
-    } else if (RightFK) {
-      int *temp_key = Right->CandidateKey->CopyOut();
-      cand_key = new KEYS_SET(temp_key, Right->CandidateKey->GetSize());
-      delete[] temp_key;
-    }
-  } else {
-    int *temp_key = Left->CandidateKey->CopyOut();
-    cand_key = new KEYS_SET(temp_key, Left->CandidateKey->GetSize());
-    delete[] temp_key;
-    cand_key->Merge(*Right->CandidateKey);
+  if (IsFKJoin && RightFK)
+    cand_key = new KEYS_SET(*Right->CandidateKey);
+  else {
+    cand_key = new KEYS_SET(*Left->CandidateKey);
+    if (!IsFKJoin) cand_key->Merge(*Right->CandidateKey);
   }
 
   LOG_COLL_PROP *result = new LOG_COLL_PROP((float)Card, (float)UCard, schema, cand_key);
 
   // foreign key is the merge of left foreign keys and right foreign keys
-  for (i = 0; i < Left->FKeyList.size(); i++) {
-    FOREIGN_KEY *fk = new FOREIGN_KEY(*Left->FKeyList[i]);
-    result->FKeyList.push_back(fk);
-  }
-  for (i = 0; i < Right->FKeyList.size(); i++) {
-    FOREIGN_KEY *fk = new FOREIGN_KEY(*Right->FKeyList[i]);
-    result->FKeyList.push_back(fk);
-  }
+  result->FKeyList = Left->FKeyList;
+  result->FKeyList.insert(result->FKeyList.end(), Right->FKeyList.begin(), Right->FKeyList.end());
 
   return result;
 }
@@ -353,16 +314,12 @@ ub4 EQJOIN::hash() {
     hashval = lookup2(lattrs[i], hashval);
     hashval = lookup2(rattrs[i], hashval);
   }
-  return (hashval % (HtblSize - 1));
+  return hashval;
 }
 /*********** DUMMY functions ****************/
-DUMMY::DUMMY() {
-  name = GetName();  // for debug
-};
+DUMMY::DUMMY(){};
 
-DUMMY::DUMMY(DUMMY &Op) {
-  name = Op.name;  // for debug
-};
+DUMMY::DUMMY(DUMMY &Op){};
 
 string DUMMY::Dump() { return GetName(); }
 
@@ -392,13 +349,8 @@ LOG_PROP *DUMMY::FindLogProp(LOG_PROP **input) {
     UCard = Left->UCard * Right->UCard;
 
   // the candidate key is the merge of two candidate keys from the inputs
-  KEYS_SET *cand_key;
-  {
-    int *temp_key = Left->CandidateKey->CopyOut();
-    cand_key = new KEYS_SET(temp_key, Left->CandidateKey->GetSize());
-    delete[] temp_key;
-    cand_key->Merge(*Right->CandidateKey);
-  }
+  KEYS_SET *cand_key = new KEYS_SET(*Left->CandidateKey);
+  cand_key->Merge(*Right->CandidateKey);
 
   LOG_COLL_PROP *result = new LOG_COLL_PROP((float)Card, (float)UCard, Schema, cand_key);
   return result;
@@ -408,18 +360,14 @@ LOG_PROP *DUMMY::FindLogProp(LOG_PROP **input) {
 ub4 DUMMY::hash() {
   ub4 hashval = GetInitval();
 
-  return (hashval % (HtblSize - 1));
+  return hashval;
 }
 
 /*********** PROJECT functions ****************/
 
-PROJECT::PROJECT(int *attrs, int size) : attrs(attrs), size(size) {
-  name = GetName();  // for debug
-};
+PROJECT::PROJECT(int *attrs, int size) : attrs(attrs), size(size){};
 
-PROJECT::PROJECT(PROJECT &Op) : attrs(CopyArray(Op.attrs, Op.size)), size(Op.size) {
-  name = Op.name;  // for debug
-};
+PROJECT::PROJECT(PROJECT &Op) : attrs(CopyArray(Op.attrs, Op.size)), size(Op.size){};
 
 ub4 PROJECT::hash() {
   ub4 hashval = GetInitval();
@@ -427,7 +375,7 @@ ub4 PROJECT::hash() {
   // to check the equality of the conditions
   for (int i = size; --i >= 0;) hashval = lookup2(attrs[i], hashval);
 
-  return (hashval % (HtblSize - 1));
+  return hashval;
 }
 
 //##ModelId=3B0C08740223
@@ -450,11 +398,9 @@ LOG_PROP *PROJECT::FindLogProp(LOG_PROP **input) {
   new_ucard = MIN(new_ucard, rel_input->Card);
 
   KEYS_SET *cand_key;
-  if (rel_input->CandidateKey->IsSubSet(attrs, size)) {
-    int *temp_key = rel_input->CandidateKey->CopyOut();
-    cand_key = new KEYS_SET(temp_key, rel_input->CandidateKey->GetSize());
-    delete[] temp_key;
-  } else
+  if (rel_input->CandidateKey->IsSubSet(attrs, size))
+    cand_key = new KEYS_SET(*rel_input->CandidateKey);
+  else
     cand_key = new KEYS_SET();
 
   LOG_COLL_PROP *result = new LOG_COLL_PROP(rel_input->Card, new_ucard, schema, cand_key);
@@ -462,7 +408,7 @@ LOG_PROP *PROJECT::FindLogProp(LOG_PROP **input) {
   // if foreign keys are subset of project attrs, pass this foreign key
   for (int i = 0; i < rel_input->FKeyList.size(); i++) {
     if (rel_input->FKeyList[i]->ForeignKey->IsSubSet(attrs, size))
-      result->FKeyList.push_back(new FOREIGN_KEY(*rel_input->FKeyList[i]));
+      result->FKeyList.push_back(rel_input->FKeyList[i]);
   }
 
   return result;
@@ -482,13 +428,9 @@ string PROJECT::Dump() {
   return os;
 }
 
-SELECT::SELECT() {
-  name = GetName();  // for debug
-};
+SELECT::SELECT(){};
 
-SELECT::SELECT(SELECT &Op) {
-  name = Op.name;  // for debug
-};
+SELECT::SELECT(SELECT &Op){};
 
 //##ModelId=3B0C08740116
 LOG_PROP *SELECT::FindLogProp(LOG_PROP **input) {
@@ -534,18 +476,14 @@ LOG_PROP *SELECT::FindLogProp(LOG_PROP **input) {
 ub4 SELECT::hash() {
   ub4 hashval = GetInitval();
 
-  return (hashval % (HtblSize - 1));
+  return hashval;
 }
 
 string SELECT::Dump() { return GetName(); }
 
-RM_DUPLICATES::RM_DUPLICATES() {
-  name = GetName();  // for debug
-};
+RM_DUPLICATES::RM_DUPLICATES(){};
 
-RM_DUPLICATES::RM_DUPLICATES(RM_DUPLICATES &Op) {
-  name = Op.name;  // for debug
-};
+RM_DUPLICATES::RM_DUPLICATES(RM_DUPLICATES &Op){};
 
 LOG_PROP *RM_DUPLICATES::FindLogProp(LOG_PROP **input) {
   LOG_COLL_PROP *rel_input = (LOG_COLL_PROP *)input[0];
@@ -577,7 +515,7 @@ LOG_PROP *RM_DUPLICATES::FindLogProp(LOG_PROP **input) {
 ub4 RM_DUPLICATES::hash() {
   ub4 hashval = GetInitval();
 
-  return (hashval % (HtblSize - 1));
+  return hashval;
 }
 
 string RM_DUPLICATES::Dump() { return GetName(); }
@@ -602,8 +540,6 @@ AGG_LIST::AGG_LIST(int *gby_atts, int gby_size, AGG_OP_ARRAY *agg_ops)
     FlattenedAtts = 0;
     FAttsSize = 0;
   }
-
-  name = GetName();  // for debug
 }
 
 //##ModelId=3B0C087500EE
@@ -621,7 +557,7 @@ ub4 AGG_LIST::hash() {
     hashval = lookup2(FlattenedAtts[i], hashval);
   }
 
-  return (hashval % (HtblSize - 1));
+  return hashval;
 }
 
 //##ModelId=3B0C087500BD
@@ -659,9 +595,9 @@ LOG_PROP *AGG_LIST::FindLogProp(LOG_PROP **input) {
   Schema *agg_schema = new Schema(NumOps);
   for (i = 0; i < NumOps; i++) {
     AGG_OP *aggop = (*AggOps)[i];
-    Attribute *new_attr = new Attribute(aggop->GetRangeVar(), aggop->GetAtts(), aggop->GetAttsSize());
+    Attribute new_attr(aggop->GetRangeVar(), aggop->GetAtts(), aggop->GetAttsSize());
     // CuCard is the same as group by
-    new_attr->CuCard = new_cucard;
+    new_attr.CuCard = new_cucard;
     agg_schema->AddAttr(i, new_attr);
   }
 
@@ -690,7 +626,7 @@ LOG_PROP *AGG_LIST::FindLogProp(LOG_PROP **input) {
   // if foreign keys are subset of gby attrs, pass this foreign key
   for (i = 0; i < rel_input->FKeyList.size(); i++) {
     if (rel_input->FKeyList[i]->ForeignKey->IsSubSet(GbyAtts, GbySize))
-      result->FKeyList.push_back(new FOREIGN_KEY(*rel_input->FKeyList[i]));
+      result->FKeyList.push_back(rel_input->FKeyList[i]);
   }
   return result;
 }  // AGG_LIST::FindLogProp
@@ -723,7 +659,7 @@ string AGG_LIST::Dump() {
 
 bool AGG_LIST::operator==(Operator *other) {
   bool result;
-  result = other->GetNameId() == GetNameId() && EqualArray(((AGG_LIST *)other)->GbyAtts, GbyAtts, GbySize);
+  result = other->GetOpcode() == GetOpcode() && EqualArray(((AGG_LIST *)other)->GbyAtts, GbyAtts, GbySize);
 
   // traverse the agg_ops
   if (result) {
@@ -745,9 +681,9 @@ LOG_PROP *FUNC_OP::FindLogProp(LOG_PROP **input) {
   Schema *temp_schema = new Schema(*(rel_input->schema));
 
   Schema *new_schema = new Schema(1);
-  Attribute *new_attr = new Attribute(RangeVar, Atts, AttsSize);
+  Attribute new_attr(RangeVar, Atts, AttsSize);
   // the CuCard is the UCard of the input relation
-  new_attr->CuCard = rel_input->UCard;
+  new_attr.CuCard = rel_input->UCard;
   new_schema->AddAttr(0, new_attr);
 
   new_schema->TableId = 0;
@@ -781,7 +717,7 @@ ub4 FUNC_OP::hash() {
     hashval = lookup2(Atts[i], hashval);
   }
 
-  return (hashval % (HtblSize - 1));
+  return hashval;
 }
 
 string FUNC_OP::Dump() {
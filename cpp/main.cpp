@@ -13,9 +13,9 @@
 #define KEYWORD_PIGGYBACK "PiggyBack"
 
 // Rule Firing Statistics
-INT_ARRAY TopMatch;
-INT_ARRAY Bindings;
-INT_ARRAY Conditions;
+COUNTER_ARRAY TopMatch;
+COUNTER_ARRAY Bindings;
+COUNTER_ARRAY Conditions;
 
 void Optimizer() {
   TaskNo = 0;
@@ -34,13 +34,12 @@ void Optimizer() {
   PTRACE("cost model content: " << endl << costModel->Dump());
   ruleSet = new RuleSet();
   PTRACE("Rule set content:" << endl << ruleSet->Dump());
-  Cost *HeuristicCost;
-  HeuristicCost = new Cost(0);
+  Cost HeuristicCost(0);
 
   // Initialize Rule Firing Statistics
-  TopMatch.resize(ruleSet->RuleCount);
-  Bindings.resize(ruleSet->RuleCount);
-  Conditions.resize(ruleSet->RuleCount);  // 625
+  TopMatch = COUNTER_ARRAY(ruleSet->RuleCount);
+  Bindings = COUNTER_ARRAY(ruleSet->RuleCount);
+  Conditions = COUNTER_ARRAY(ruleSet->RuleCount);  // 625
   for (int RuleNum = 0; RuleNum < ruleSet->RuleCount; RuleNum++) {
     TopMatch[RuleNum] = 0;
     Bindings[RuleNum] = 0;
@@ -200,11 +199,10 @@ void Optimizer() {
         delete query;
         Ssp->optimize();
         PHYS_PROP *PhysProp = CONT::vc[0]->GetPhysProp();
-        *HeuristicCost = *(Ssp->GetGroup(0)->GetWinner(PhysProp)->GetCost());
+        HeuristicCost = Ssp->GetGroup(0)->GetWinner(PhysProp)->GetCost();
         assert(Ssp->GetGroup(0)->GetWinner(PhysProp)->GetDone());
         delete Ssp;
-        for (int i = 0; i < CONT::vc.size(); i++) delete CONT::vc[i];
-        CONT::vc.clear();
+        CONT::Clear();
         delete Cat;
         GlobepsPruning = true;
         ForGlobalEpsPruning = false;
@@ -283,8 +281,7 @@ void Optimizer() {
 
         // Delete Contexts, close batch query file, delete search space
         if (!PiggyBack) {
-          for (int i = 0; i < CONT::vc.size(); i++) delete CONT::vc[i];
-          CONT::vc.clear();
+          CONT::Clear();
         }
         // if (RadioVal ==0 && q==NumQuery-1) fclose(fp);
         // Go on with the usual procedure of deleting the search space before
@@ -315,8 +312,7 @@ void Optimizer() {
     // to delete the search space one last time
     if (PiggyBack) {
       delete Ssp;
-      for (int i = 0; i < CONT::vc.size(); i++) delete CONT::vc[i];
-      CONT::vc.clear();
+      CONT::Clear();
     }
 
   } while (!feof(fp));  // end of do loop  over each batch query sequence
@@ -325,7 +321,6 @@ void Optimizer() {
   delete OptStat;
   delete costModel;
   delete ruleSet;
-  delete HeuristicCost;
 
   OutputFile.close();
   OutputCOVE.close();
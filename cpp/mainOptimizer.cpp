@@ -4,35 +4,219 @@
 #include "../header/global.h"
 #include "../header/physop.h"
 
-INT_ARRAY TopMatch;
-INT_ARRAY Bindings;
-INT_ARRAY Conditions;
+COUNTER_ARRAY TopMatch;
+COUNTER_ARRAY Bindings;
+COUNTER_ARRAY Conditions;
+
+static void Usage(char const *name) {
+  cout << "usage: " << name
+       << " [--threads N] [--query FILE] [--catalog FILE] [--cost FILE] [--trace off|error|info|debug|cove]"
+       << " [--deadline-ms MS] [--join-enum rules|dpccp|goo|random] [--join-rules rs-b2|rs-b0] [--goo-threshold N]"
+       << " [--cartesian allow|original|forbid|card] [--cartesian-card N]"
+       << " [--random-moves N] [--random-ms MS] [--random-seed S] [--seed-bound on|off] [--global-eps PCT]" << endl;
+}
+
+// Optimize the query without the join reordering rules, each join block in its greedy order, and return the cost of
+// the plan found, infinite if none.  The full search finds every plan of this first pass, so the cost bounds it.
+static Cost SeedPlan(const string &QueryFile, const string &CatalogFile) {
+  JOIN_ENUM Enum = JoinEnum;
+  OPT_STAT *Stat = OptStat;
+  JoinEnum = JOIN_GOO;
+  ForGlobalEpsPruning = true;
+  OptStat = new OPT_STAT;
+  chrono::steady_clock::time_point Start = chrono::steady_clock::now();
+
+  // Since each optimization corrupts the catalog, we must create it anew
+  Cat = new CAT(CatalogFile);
+  query = new Query(QueryFile);
+  Ssp = new SearchSpace;
+  Ssp->Init();
+  delete query;
+
+  Ssp->optimize();
+
+  Cost SeedCost = Cost::Infinite();
+  WINNER *Winner = Ssp->GetGroup(Ssp->GetRootGID())->GetWinner(CONT::vc[0]->GetPhysProp());
+  if (Winner && Winner->GetMPlan()) SeedCost = Winner->GetCost();
+
+  chrono::duration<double, milli> Elapsed = chrono::steady_clock::now() - Start;
+  OUTPUT("Seed Plan: " << SeedCost.Dump() << ", " << TaskNo << " tasks, " << Elapsed.count() << "ms");
+
+  delete Ssp;
+  CONT::Clear();
+  delete Cat;
+  delete OptStat;
+  OptStat = Stat;
+  JoinEnum = Enum;
+  ForGlobalEpsPruning = false;
+  TaskNo = 0;
+  Memo_M_Exprs = 0;
+  return SeedCost;
+}
+
+static const char *TraceNames[] = {"off", "error", "info", "debug", "cove"};
 
 int main(int argc, char const *argv[]) {
+  string QueryFile = "../case/query";
+  string CatalogFile = "../case/catalog";
+  string CostFile = "../case/cost";
+
+  for (int i = 1; i < argc; i++) {
+    string arg = argv[i];
+    if (i + 1 == argc) {
+      Usage(argv[0]);
+      return 1;
+    }
+    if (arg == "--threads") {
+      Threads = atoi(argv[++i]);
+      if (Threads < 1) {
+        Usage(argv[0]);
+        return 1;
+      }
+    } else if (arg == "--query")
+      QueryFile = argv[++i];
+    else if (arg == "--catalog")
+      CatalogFile = argv[++i];
+    else if (arg == "--cost")
+      CostFile = argv[++i];
+    else if (arg == "--deadline-ms") {
+      DeadlineMs = atoi(argv[++i]);
+      if (DeadlineMs < 1) {
+        Usage(argv[0]);
+        return 1;
+      }
+    } else if (arg == "--join-enum") {
+      string engine = argv[++i];
+      if (engine == "rules")
+        JoinEnum = JOIN_RULES;
+      else if (engine == "dpccp")
+        JoinEnum = JOIN_DPCCP;
+      else if (engine == "goo")
+        JoinEnum = JOIN_GOO;
+      else if (engine == "random")
+        JoinEnum = JOIN_RANDOM;
+      else {
+        Usage(argv[0]);
+        return 1;
+      }
+    } else if (arg == "--join-rules") {
+      string rules = argv[++i];
+      if (rules == "rs-b2")
+        JoinRuleSet = RS_B2;
+      else if (rules == "rs-b0")
+        JoinRuleSet = RS_B0;
+      else {
+        Usage(argv[0]);
+        return 1;
+      }
+    } else if (arg == "--cartesian") {
+      string policy = argv[++i];
+      if (policy == "allow")
+        Cartesian = CART_ALLOW;
+      else if (policy == "original")
+        Cartesian = CART_ORIGINAL;
+      else if (policy == "forbid")
+        Cartesian = CART_FORBID;
+      else if (policy == "card")
+        Cartesian = CART_CARD;
+      else {
+        Usage(argv[0]);
+        return 1;
+      }
+    } else if (arg == "--cartesian-card") {
+      CartesianMaxCard = atof(argv[++i]);
+      if (CartesianMaxCard < 0) {
+        Usage(argv[0]);
+        return 1;
+      }
+    } else if (arg == "--goo-threshold") {
+      GooThreshold = atoi(argv[++i]);
+      if (GooThreshold < 0) {
+        Usage(argv[0]);
+        return 1;
+      }
+    } else if (arg == "--random-moves") {
+      RandomMaxMoves = atoi(argv[++i]);
+      if (RandomMaxMoves < 1) {
+        Usage(argv[0]);
+        return 1;
+      }
+    } else if (arg == "--random-ms") {
+      RandomMaxMs = atoi(argv[++i]);
+      if (RandomMaxMs < 1) {
+        Usage(argv[0]);
+        return 1;
+      }
+    } else if (arg == "--seed-bound") {
+      string seed = argv[++i];
+      if (seed == "on")
+        SeedBound = true;
+      else if (seed == "off")
+        SeedBound = false;
+      else {
+        Usage(argv[0]);
+        return 1;
+      }
+    } else if (arg == "--global-eps") {
+      GlobalEpsPercent = atof(argv[++i]);
+      if (GlobalEpsPercent <= 0) {
+        Usage(argv[0]);
+        return 1;
+      }
+      GlobepsPruning = true;
+    } else if (arg == "--random-seed")
+      RandomSeed = strtoul(argv[++i], nullptr, 10);
+    else if (arg == "--trace") {
+      string level = argv[++i];
+      int l = 0;
+      while (l < slotsof(TraceNames) && level != TraceNames[l]) l++;
+      if (l == slotsof(TraceNames)) {
+        Usage(argv[0]);
+        return 1;
+      }
+      if (l > TRACE_MAX_LEVEL)
+        cout << "trace level " << level << " is not compiled in, rebuild with -DTRACE_LEVEL=" << level << endl;
+      TraceLevel = (TRACE_LEVEL)l;
+    } else {
+      Usage(argv[0]);
+      return 1;
+    }
+  }
+
   OutputFile.open("../colout.txt");
-  OutputCOVE.open("../script.cove");
+  if (TRACING(TRACE_COVE)) OutputCOVE.open("../script.cove");
 
   ForGlobalEpsPruning = false;
   OptStat = new OPT_STAT;
   ruleSet = new RuleSet();
   // Initialize Rule Firing Statistics
-  TopMatch.resize(ruleSet->RuleCount);
-  Bindings.resize(ruleSet->RuleCount);
-  Conditions.resize(ruleSet->RuleCount);  // 625
+  TopMatch = COUNTER_ARRAY(ruleSet->RuleCount);
+  Bindings = COUNTER_ARRAY(ruleSet->RuleCount);
+  Conditions = COUNTER_ARRAY(ruleSet->RuleCount);  // 625
   for (int RuleNum = 0; RuleNum < ruleSet->RuleCount; RuleNum++) {
     TopMatch[RuleNum] = 0;
     Bindings[RuleNum] = 0;
     Conditions[RuleNum] = 0;
   }
 
-  costModel = new CostModel("../case/cost");
+  costModel = new CostModel(CostFile);
+
+  Cost HeuristicCost(0);
 
-  Cost *HeuristicCost = new Cost(0);
+  // The cost of a seed plan bounds the search and sets GLOBAL_EPS.  Only a search which finds every plan of the
+  // first pass may be bounded by it: not the randomized one, nor one cut short.
+  Cost UpperBd = Cost::Infinite();
+  if (SeedBound || GlobepsPruning) {
+    HeuristicCost = SeedPlan(QueryFile, CatalogFile);
+    if (GlobepsPruning) GLOBAL_EPS = HeuristicCost.is_infinite() ? 0 : HeuristicCost.GetValue() * GlobalEpsPercent / 100;
+    if (SeedBound && !HeuristicCost.is_infinite() && JoinEnum != JOIN_RANDOM && DeadlineMs <= 0 && !Halt)
+      UpperBd = Cost(HeuristicCost.GetValue() * (1 + SEED_SLACK));
+  }
 
-  Cat = new CAT("../case/catalog");
+  Cat = new CAT(CatalogFile);
   cout << Cat->Dump() << endl;
 
-  query = new Query("../case/query");
+  query = new Query(QueryFile);
   cout << endl << query->Dump() << endl;
   cout << endl << query->Dump_IntOrders() << endl;
 
@@ -47,7 +231,23 @@ int main(int argc, char const *argv[]) {
 
   cout << "Optimization beginning time:" << put_time(localtime(&timet), "%c %Z") << "(hr:min : sec.msec)\n" << endl;
 
-  Ssp->optimize();
+  Ssp->optimize(UpperBd);
+
+  // The winners global epsilon pruning takes may cost more than those of the seed plan, so the bound may leave no
+  // plan at all.  Then search again without it.
+  WINNER *Winner = Ssp->GetGroup(Ssp->GetRootGID())->GetWinner(CONT::vc[0]->GetPhysProp());
+  if (!UpperBd.is_infinite() && !(Winner && Winner->GetMPlan())) {
+    OUTPUT("No plan costs less than the seed bound " << UpperBd.Dump() << ", optimizing again without it");
+    delete Ssp;
+    CONT::Clear();
+    delete Cat;
+    Cat = new CAT(CatalogFile);
+    query = new Query(QueryFile);
+    Ssp = new SearchSpace;
+    Ssp->Init();
+    delete query;
+    Ssp->optimize();
+  }
 
   std::chrono::duration<double, std::milli> diff = std::chrono::system_clock::now() - now;
   cout << "Optimization elapsed time:" << (diff).count() << "ms" << endl;
@@ -55,11 +255,10 @@ int main(int argc, char const *argv[]) {
 
   PHYS_PROP *PhysProp = CONT::vc[0]->GetPhysProp();
   Ssp->CopyOut(Ssp->GetRootGID(), PhysProp, 0);
-  *HeuristicCost = *(Ssp->GetGroup(0)->GetWinner(PhysProp)->GetCost());
+  HeuristicCost = Ssp->GetGroup(0)->GetWinner(PhysProp)->GetCost();
   assert(Ssp->GetGroup(0)->GetWinner(PhysProp)->GetDone());
   delete Ssp;
-  for (int i = 0; i < CONT::vc.size(); i++) delete CONT::vc[i];
-  CONT::vc.clear();
+  CONT::Clear();
   delete Cat;
   ForGlobalEpsPruning = false;
   OUTPUT(ruleSet->DumpStats());
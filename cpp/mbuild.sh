@@ -1 +1 @@
-g++ -g  supp.cpp cat.cpp group.cpp item.cpp logop.cpp  physop.cpp query.cpp rules.cpp ssp.cpp tasks.cpp mainOptimizer.cpp -std=c++20
\ No newline at end of file
+g++ -g  supp.cpp cat.cpp group.cpp item.cpp logop.cpp  physop.cpp query.cpp rules.cpp ssp.cpp joinenum.cpp tasks.cpp mainOptimizer.cpp -std=c++20
\ No newline at end of file
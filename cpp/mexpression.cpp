@@ -6,8 +6,9 @@ MExression::MExression(Expression *Expr, int grpid)
     : Op(Expr->GetOp()->Clone()),
       NextMExpr(nullptr),
       GrpID((grpid == NEW_GRPID) ? Ssp->GetNewGrpID() : grpid),
-      HashPtr(nullptr),
-      RuleMask(0) {
+      Arity(Op->GetArity()),
+      Inputs(Arity <= INLINE_ARITY ? InlineInputs : new int[Arity]),
+      HashVal(0) {
   int groupID;
   Expression *input;
 
@@ -21,21 +22,66 @@ MExression::MExression(Expression *Expr, int grpid)
         groupID = ((LeafOperator *)input->GetOp())->GetGroup();
       else {
         // create a new sub group
-        if (Op->GetName() == "DUMMY")
+        if (Op->GetOpcode() == OPCODE::DUMMY)
           groupID = NEW_GRPID_NOWIN;  // DUMMY subgroups have only trivial winners
         else
           groupID = NEW_GRPID;
         MExression *MExpr = Ssp->CopyIn(input, groupID);
       }
-      children_.push_back(groupID);
+      Inputs[i] = groupID;
     }
   }  // if(arity)
+
+  // the hash is used to find duplicates, which are looked for only among logical mexprs
+  if (Op->is_logical()) SetHash();
 };
 
 MExression::MExression(MExression &other)
-    : GrpID(other.GrpID),
-      HashPtr(other.HashPtr),
-      NextMExpr(other.NextMExpr),
-      children_(other.children_),
-      Op(other.Op->Clone()),
-      RuleMask(other.RuleMask){};
\ No newline at end of file
+    : Op(other.Op->Clone()),
+      NextMExpr(other.NextMExpr.load()),
+      GrpID(other.GrpID),
+      Arity(other.Arity),
+      Inputs(Arity <= INLINE_ARITY ? InlineInputs : new int[Arity]),
+      HashVal(other.HashVal),
+      RuleMask(other.RuleMask.load()) {
+  for (int i = 0; i < Arity; i++) Inputs[i] = other.Inputs[i];
+};
+void *MExression::operator new(size_t size) { return Ssp->GetArena().alloc(size); }
+
+void MExression::operator delete(void *p, size_t size) { Ssp->GetArena().free(p, size); }
+
+void MExression::SetHash() {
+  HashVal = Op->hash();
+
+  // to check the equality of the inputs
+  for (int input_no = GetArity(); --input_no >= 0;) HashVal = lookup2(GetInput(input_no), HashVal);
+}
+
+void MExression::MergeInput(int FromGid, int ToGid) {
+  for (int i = 0; i < Arity; i++)
+    if (Inputs[i] == FromGid) Inputs[i] = ToGid;
+  SetHash();
+}
+
+bool MExression::operator==(MExression &other) {
+  int Arity = GetArity();
+
+  // See if they have the same arities
+  if (other.GetArity() != Arity) return false;
+
+  // compare the inputs
+  // Compare the actual group pointers for every input
+  for (int input_no = Arity; --input_no >= 0;)
+    if (GetInput(input_no) != other.GetInput(input_no)) {
+      PTRACE("Different at input " << input_no);
+      return false;
+    }
+
+  // finally compare the Op
+  if (!(*(other.GetOp()) == GetOp())) {
+    PTRACE("Different at Operator. " << other.Dump() << " : " << Dump());
+    return false;
+  }
+
+  return true;
+}
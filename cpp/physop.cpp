@@ -54,13 +54,9 @@ double FetchingCost(LOG_COLL_PROP *LogProp) {
   return Total;
 }
 
-FILE_SCAN ::FILE_SCAN(const int fileId) : FileId(fileId) {
-  name = GetName() + GetCollName(FileId);
-};
+FILE_SCAN ::FILE_SCAN(const int fileId) : FileId(fileId){};
 
-FILE_SCAN::FILE_SCAN(FILE_SCAN &Op) : FileId(Op.GetFileId()) {
-  name = Op.name;
-}
+FILE_SCAN::FILE_SCAN(FILE_SCAN &Op) : FileId(Op.GetFileId()) {}
 
 PHYS_PROP *FILE_SCAN::FindPhysProp(PHYS_PROP **input_phys_props) {
   CollectionsProperties *CollProp = Cat->GetCollProp(FileId);
@@ -75,26 +71,22 @@ PHYS_PROP *FILE_SCAN::FindPhysProp(PHYS_PROP **input_phys_props) {
   }
 }
 
-Cost *FILE_SCAN::FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) {
+Cost FILE_SCAN::FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) {
   float Card = ((LOG_COLL_PROP *)LocalLogProp)->Card;
   float Width = ((LOG_COLL_PROP *)LocalLogProp)->schema->GetTableWidth(0);
   // cost = 表体积 * 读取cost
-  Cost *Result = new Cost(ceil(Card * Width) * (costModel->cpu_read() +  // cpu cost of reading from disk
-                                                costModel->io())         // i/o cost of reading from disk
+  Cost Result(ceil(Card * Width) * (costModel->cpu_read() +  // cpu cost of reading from disk
+                                    costModel->io())         // i/o cost of reading from disk
   );
   return (Result);
 }
 
-LOOPS_JOIN::LOOPS_JOIN(int *lattrs, int *rattrs, int size) : lattrs(lattrs), rattrs(rattrs), size(size) {
-  name = GetName();
-}
+LOOPS_JOIN::LOOPS_JOIN(int *lattrs, int *rattrs, int size) : lattrs(lattrs), rattrs(rattrs), size(size) {}
 
 LOOPS_JOIN::LOOPS_JOIN(LOOPS_JOIN &Op)
-    : lattrs(CopyArray(Op.lattrs, Op.size)), rattrs(CopyArray(Op.rattrs, Op.size)), size(Op.size) {
-  name = GetName();
-};
+    : lattrs(CopyArray(Op.lattrs, Op.size)), rattrs(CopyArray(Op.rattrs, Op.size)), size(Op.size){};
 
-Cost *LOOPS_JOIN::FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) {
+Cost LOOPS_JOIN::FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) {
   float LeftCard = ((LOG_COLL_PROP *)InputLogProp[0])->Card;
   float RightCard = ((LOG_COLL_PROP *)InputLogProp[1])->Card;
 
@@ -102,8 +94,8 @@ Cost *LOOPS_JOIN::FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp)
 
   // 表join条件计算和数据copy的代价
   // 如果是overflow的情况，需要计算io|  如果是分布式，需要计算网络IO
-  Cost *result = new Cost(LeftCard * RightCard * costModel->cpu_pred()  // cpu cost of predicates
-                          + OutputCard * costModel->touch_copy()        // cpu cost of copying result
+  Cost result(LeftCard * RightCard * costModel->cpu_pred()  // cpu cost of predicates
+              + OutputCard * costModel->touch_copy()        // cpu cost of copying result
   );
 
   return (result);
@@ -155,20 +147,20 @@ string LOOPS_JOIN::Dump() {
   return os;
 };
 
-PDUMMY::PDUMMY() { name = GetName(); }
+PDUMMY::PDUMMY() {}
 
-PDUMMY::PDUMMY(PDUMMY &Op) { name = GetName(); };
+PDUMMY::PDUMMY(PDUMMY &Op) {};
 
 // Imitate LOOPS_JOIN - why not?
-Cost *PDUMMY::FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) {
+Cost PDUMMY::FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) {
   float LeftCard = ((LOG_COLL_PROP *)InputLogProp[0])->Card;
   float RightCard = ((LOG_COLL_PROP *)InputLogProp[1])->Card;
 
   float OutputCard = ((LOG_COLL_PROP *)LocalLogProp)->Card;
 
-  Cost *result = new Cost(LeftCard * RightCard * costModel->cpu_pred()  // cpu cost of predicates
-                          + OutputCard * costModel->touch_copy()        // cpu cost of copying result
-                                                                        // no i/o cost
+  Cost result(LeftCard * RightCard * costModel->cpu_pred()  // cpu cost of predicates
+              + OutputCard * costModel->touch_copy()        // cpu cost of copying result
+                                                            // no i/o cost
   );
 
   return (result);
@@ -204,30 +196,26 @@ Nested loops index join
 */
 
 LOOPS_INDEX_JOIN::LOOPS_INDEX_JOIN(int *lattrs, int *rattrs, int size, int CollId)
-    : lattrs(lattrs), rattrs(rattrs), size(size), CollId(CollId) {
-  name = GetName();
-}  // LOOPS_INDEX_JOIN::LOOPS_INDEX_JOIN
+    : lattrs(lattrs), rattrs(rattrs), size(size), CollId(CollId) {}  // LOOPS_INDEX_JOIN::LOOPS_INDEX_JOIN
 
 LOOPS_INDEX_JOIN::LOOPS_INDEX_JOIN(LOOPS_INDEX_JOIN &Op)
-    : lattrs(CopyArray(Op.lattrs, Op.size)), rattrs(CopyArray(Op.rattrs, Op.size)), size(Op.size), CollId(Op.CollId) {
-  name = GetName();
-};
+    : lattrs(CopyArray(Op.lattrs, Op.size)), rattrs(CopyArray(Op.rattrs, Op.size)), size(Op.size), CollId(Op.CollId){};
 
-Cost *LOOPS_INDEX_JOIN::FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) {
+Cost LOOPS_INDEX_JOIN::FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) {
   float LeftCard = ((LOG_COLL_PROP *)InputLogProp[0])->Card;
   float RightCard = Cat->GetCollProp(CollId)->Card;
   float RightWidth = Cat->GetCollProp(CollId)->Width;
 
   float OutputCard = ((LOG_COLL_PROP *)LocalLogProp)->Card;
 
-  Cost *result = new Cost(LeftCard * costModel->index_probe()  // cpu cost of finding index
-                          + OutputCard                         // number of result tuples
-                                * (2 * costModel->cpu_read()   // cpu cost of reading right index and result
-                                   + costModel->touch_copy())  // cpu cost of copying left result
-                          + MIN(LeftCard, ceil(RightCard / costModel->index_bf()))  // number of index blocks
-                                * costModel->io()                                   // i/o cost of reading right index
-                          + MIN(OutputCard, ceil(RightCard * RightWidth))           // number of result blocks
-                                * costModel->io()                                   // i/o cost of reading right result
+  Cost result(LeftCard * costModel->index_probe()  // cpu cost of finding index
+              + OutputCard                         // number of result tuples
+                    * (2 * costModel->cpu_read()   // cpu cost of reading right index and result
+                       + costModel->touch_copy())  // cpu cost of copying left result
+              + MIN(LeftCard, ceil(RightCard / costModel->index_bf()))  // number of index blocks
+                    * costModel->io()                                   // i/o cost of reading right index
+              + MIN(OutputCard, ceil(RightCard * RightWidth))           // number of result blocks
+                    * costModel->io()                                   // i/o cost of reading right result
   );
 
   return (result);
@@ -284,24 +272,20 @@ Merge join
 ==========
 */
 
-MERGE_JOIN::MERGE_JOIN(int *lattrs, int *rattrs, int size) : lattrs(lattrs), rattrs(rattrs), size(size) {
-  name = GetName();
-}  // MERGE_JOIN::MERGE_JOIN
+MERGE_JOIN::MERGE_JOIN(int *lattrs, int *rattrs, int size) : lattrs(lattrs), rattrs(rattrs), size(size) {}  // MERGE_JOIN::MERGE_JOIN
 
 MERGE_JOIN::MERGE_JOIN(MERGE_JOIN &Op)
-    : lattrs(CopyArray(Op.lattrs, Op.size)), rattrs(CopyArray(Op.rattrs, Op.size)), size(Op.size) {
-  name = GetName();
-};
+    : lattrs(CopyArray(Op.lattrs, Op.size)), rattrs(CopyArray(Op.rattrs, Op.size)), size(Op.size){};
 
-Cost *MERGE_JOIN::FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) {
+Cost MERGE_JOIN::FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) {
   float LeftCard = ((LOG_COLL_PROP *)InputLogProp[0])->Card;
   float RightCard = ((LOG_COLL_PROP *)InputLogProp[1])->Card;
 
   float OutputCard = ((LOG_COLL_PROP *)LocalLogProp)->Card;
 
-  Cost *result = new Cost((LeftCard + RightCard) * costModel->cpu_pred()  // cpu cost of predicates
-                          + OutputCard * costModel->touch_copy()          // cpu cost of copying result
-                                                                          // no i/o cost
+  Cost result((LeftCard + RightCard) * costModel->cpu_pred()  // cpu cost of predicates
+              + OutputCard * costModel->touch_copy()          // cpu cost of copying result
+                                                              // no i/o cost
   );
 
   return (result);
@@ -375,24 +359,20 @@ HASH join
        Like Merge join, but inputs can have any property.  Operator constructs a hash table.
 */
 
-HASH_JOIN::HASH_JOIN(int *lattrs, int *rattrs, int size) : lattrs(lattrs), rattrs(rattrs), size(size) {
-  name = GetName();
-}  // HASH_JOIN::HASH_JOIN
+HASH_JOIN::HASH_JOIN(int *lattrs, int *rattrs, int size) : lattrs(lattrs), rattrs(rattrs), size(size) {}  // HASH_JOIN::HASH_JOIN
 
 HASH_JOIN::HASH_JOIN(HASH_JOIN &Op)
-    : lattrs(CopyArray(Op.lattrs, Op.size)), rattrs(CopyArray(Op.rattrs, Op.size)), size(Op.size) {
-  name = GetName();
-};
+    : lattrs(CopyArray(Op.lattrs, Op.size)), rattrs(CopyArray(Op.rattrs, Op.size)), size(Op.size){};
 
-Cost *HASH_JOIN::FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) {
+Cost HASH_JOIN::FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) {
   float LeftCard = ((LOG_COLL_PROP *)InputLogProp[0])->Card;
   float RightCard = ((LOG_COLL_PROP *)InputLogProp[1])->Card;
 
   float OutputCard = ((LOG_COLL_PROP *)LocalLogProp)->Card;
 
-  Cost *result = new Cost(RightCard * costModel->hash_cost()      // cpu cost of building hash table
-                          + LeftCard * costModel->hash_probe()    // cpu cost of finding hash bucket
-                          + OutputCard * costModel->touch_copy()  // cpu cost of copying result
+  Cost result(RightCard * costModel->hash_cost()      // cpu cost of building hash table
+              + LeftCard * costModel->hash_probe()    // cpu cost of finding hash bucket
+              + OutputCard * costModel->touch_copy()  // cpu cost of copying result
   );                                                              // no i/o cost
 
   return (result);
@@ -449,15 +429,15 @@ Filter
 ======
 */
 //##ModelId=3B0C08700050
-Cost *FILTER::FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) {
+Cost FILTER::FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) {
   float InputCard = ((LOG_COLL_PROP *)InputLogProp[0])->Card;
 
   float OutputCard = ((LOG_COLL_PROP *)LocalLogProp)->Card;
 
   // Need to have a cost for 0 tuples case	+ 1 ??
-  Cost *result = new Cost(InputCard * costModel->cpu_pred()       // cpu cost of predicates
-                          + OutputCard * costModel->touch_copy()  // cpu cost of copying result
-                                                                  // no i/o cost
+  Cost result(InputCard * costModel->cpu_pred()       // cpu cost of predicates
+              + OutputCard * costModel->touch_copy()  // cpu cost of copying result
+                                                      // no i/o cost
   );
 
   return (result);
@@ -490,16 +470,12 @@ PHYS_PROP *FILTER::InputReqdProp(PHYS_PROP *PhysProp, LOG_PROP *InputLogProp, in
   return (new PHYS_PROP(*PhysProp));
 }
 
-P_PROJECT::P_PROJECT(int *attrs, int size) : attrs(attrs), size(size) {
-  name = GetName();
-}  // P_PROJECT::P_PROJECT
+P_PROJECT::P_PROJECT(int *attrs, int size) : attrs(attrs), size(size) {}  // P_PROJECT::P_PROJECT
 
-P_PROJECT::P_PROJECT(P_PROJECT &Op) : attrs(CopyArray(Op.attrs, Op.size)), size(Op.size) {
-  name = GetName();
-};
+P_PROJECT::P_PROJECT(P_PROJECT &Op) : attrs(CopyArray(Op.attrs, Op.size)), size(Op.size){};
 
 //##ModelId=3B0C086F0367
-Cost *P_PROJECT::FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) {
+Cost P_PROJECT::FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) {
   float InputCard = ((LOG_COLL_PROP *)InputLogProp[0])->Card;
 
   float OutputCard = ((LOG_COLL_PROP *)LocalLogProp)->Card;
@@ -507,8 +483,8 @@ Cost *P_PROJECT::FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp)
   assert(InputCard == OutputCard);
 
   // Need to have a cost for 0 tuples case	+ 1 ??
-  Cost *result = new Cost(InputCard * costModel->touch_copy()  // cpu cost of copying result
-                                                               // no i/o cost
+  Cost result(InputCard * costModel->touch_copy()  // cpu cost of copying result
+                                                   // no i/o cost
   );
 
   return (result);
@@ -553,17 +529,13 @@ string P_PROJECT::Dump() {
   =======
 */
 
-QSORT::QSORT() {
-  name = GetName();
-}  // QSORT::QSORT
+QSORT::QSORT() {}  // QSORT::QSORT
 
-QSORT::QSORT(QSORT &Op) {
-  name = GetName();
-};
+QSORT::QSORT(QSORT &Op){};
 
 string QSORT::Dump() { return GetName(); }  // QSORT::Dump
 
-Cost *QSORT::FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) {
+Cost QSORT::FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) {
   float InputCard = ((LOG_COLL_PROP *)InputLogProp[0])->Card;
 
   float OutputCard = ((LOG_COLL_PROP *)LocalLogProp)->Card;
@@ -573,9 +545,9 @@ Cost *QSORT::FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) {
   // double card = MAX(1, 10000 * (1/input_card));	// bogus NaN error
   float card = MAX(1, OutputCard);
 
-  Cost *result = new Cost(2 * card * log(card) / log(2.0)  // number of comparison and move
-                          * costModel->cpu_comp_move()     // cpu cost of compare and move
-                                                           // no i/o cost
+  Cost result(2 * card * log(card) / log(2.0)  // number of comparison and move
+              * costModel->cpu_comp_move()     // cpu cost of compare and move
+                                               // no i/o cost
   );
 
   return (result);
@@ -603,16 +575,16 @@ PHYS_PROP *QSORT::InputReqdProp(PHYS_PROP *PhysProp, LOG_PROP *InputLogProp, int
 }  // QSORT::InputReqdProp
 
 //##ModelId=3B0C0870023B
-Cost *HASH_DUPLICATES::FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) {
+Cost HASH_DUPLICATES::FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) {
   float InputCard = ((LOG_COLL_PROP *)InputLogProp[0])->Card;
 
   float OutputCard = ((LOG_COLL_PROP *)LocalLogProp)->Card;
 
   // Need to have a cost for 0 tuples case	+ 1 ??
-  Cost *result = new Cost(InputCard * costModel->hash_cost()      // cpu cost of hashing
-                                                                  // assume hash collisions add negligible cost
-                          + OutputCard * costModel->touch_copy()  // cpu cost of copying result
-                                                                  // no i/o cost
+  Cost result(InputCard * costModel->hash_cost()      // cpu cost of hashing
+                                                      // assume hash collisions add negligible cost
+              + OutputCard * costModel->touch_copy()  // cpu cost of copying result
+                                                      // no i/o cost
   );
 
   return (result);
@@ -633,14 +605,14 @@ string HASH_DUPLICATES::Dump() { return GetName(); }  // HASH_DUPLICATES::Dump
 // since it actually requires more than one pass.
 // One pass to group, count and sum. and one pass to divide sum by count
 //##ModelId=3B0C087003A3
-Cost *HGROUP_LIST::FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) {
+Cost HGROUP_LIST::FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) {
   float InputCard = ((LOG_COLL_PROP *)InputLogProp[0])->Card;
   float OutputCard = ((LOG_COLL_PROP *)LocalLogProp)->Card;
 
   // Need to have a cost for 0 tuples case	+ 1 ??
-  Cost *result = new Cost(InputCard * (costModel->hash_cost()                        // cost of hashing
-                                       + costModel->cpu_apply() * (AggOps->size()))  // apply the aggregate operation
-                          + OutputCard * (costModel->touch_copy())                   // copy out the result
+  Cost result(InputCard * (costModel->hash_cost()                        // cost of hashing
+                           + costModel->cpu_apply() * (AggOps->size()))  // apply the aggregate operation
+              + OutputCard * (costModel->touch_copy())                   // copy out the result
   );
 
   return (result);
@@ -697,13 +669,13 @@ string HGROUP_LIST::Dump() {
 }  // HGROUP_LIST::Dump
 
 //##ModelId=3B0C0871011B
-Cost *P_FUNC_OP::FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) {
+Cost P_FUNC_OP::FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) {
   float InputCard = ((LOG_COLL_PROP *)InputLogProp[0])->Card;
   float OutputCard = ((LOG_COLL_PROP *)LocalLogProp)->Card;
 
   // Need to have a cost for 0 tuples case	+ 1 ??
-  Cost *result = new Cost(InputCard * costModel->cpu_apply()      // cpu cost of applying aggregate operation
-                          + OutputCard * costModel->touch_copy()  // copy out the result
+  Cost result(InputCard * costModel->cpu_apply()      // cpu cost of applying aggregate operation
+              + OutputCard * costModel->touch_copy()  // copy out the result
   );
   return (result);
 }  // P_FUNC_OP::FindLocalCost
@@ -730,34 +702,30 @@ string P_FUNC_OP::Dump() {
 }
 
 BIT_JOIN::BIT_JOIN(int *lattrs, int *rattrs, int size, int CollId)
-    : lattrs(lattrs), rattrs(rattrs), size(size), CollId(CollId) {
-  name = GetName();
-}  // BIT_JOIN::BIT_JOIN
+    : lattrs(lattrs), rattrs(rattrs), size(size), CollId(CollId) {}  // BIT_JOIN::BIT_JOIN
 
 BIT_JOIN::BIT_JOIN(BIT_JOIN &Op)
-    : lattrs(CopyArray(Op.lattrs, Op.size)), rattrs(CopyArray(Op.rattrs, Op.size)), size(Op.size), CollId(Op.CollId) {
-  name = GetName();
-};
+    : lattrs(CopyArray(Op.lattrs, Op.size)), rattrs(CopyArray(Op.rattrs, Op.size)), size(Op.size), CollId(Op.CollId){};
 
-Cost *BIT_JOIN::FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) {
+Cost BIT_JOIN::FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) {
   float LeftCard = ((LOG_COLL_PROP *)InputLogProp[0])->Card;
 
   float OutputCard = ((LOG_COLL_PROP *)LocalLogProp)->Card;
 
-  Cost *result = new Cost(LeftCard * costModel->cpu_read()    // cpu cost of reading bit vector
-                          + LeftCard * costModel->cpu_pred()  // cpu cost of check bit vector
-                                                              // the above is overstated:
-                                                              //	1. The read assumes we read 1
-                                                              //	   bit at a time
-                                                              //	2. cost of evaluating a predicate
-                                                              //	   is just checking a single bit
-                                                              //		+OutputCard
-                                                              //// number of result tuples
-                                                              //		 * costModel->touch_copy()
-                                                              //// cpu cost of projecting and
-                                                              // copying result
-                          + (LeftCard / costModel->bit_bf())  // number of bit vector blocks
-                                * costModel->io()             // i/o cost of reading bit vector
+  Cost result(LeftCard * costModel->cpu_read()    // cpu cost of reading bit vector
+              + LeftCard * costModel->cpu_pred()  // cpu cost of check bit vector
+                                                  // the above is overstated:
+                                                  //	1. The read assumes we read 1
+                                                  //	   bit at a time
+                                                  //	2. cost of evaluating a predicate
+                                                  //	   is just checking a single bit
+                                                  //		+OutputCard
+                                                  //// number of result tuples
+                                                  //		 * costModel->touch_copy()
+                                                  //// cpu cost of projecting and
+                                                  // copying result
+              + (LeftCard / costModel->bit_bf())  // number of bit vector blocks
+                    * costModel->io()             // i/o cost of reading bit vector
   );
 
   return (result);
@@ -814,15 +782,11 @@ PHYS_PROP *BIT_JOIN::FindPhysProp(PHYS_PROP **input_phys_props) {
 }  // BIT_JOIN::FindPhysProp
 
 // INDEXED_FILTER
-INDEXED_FILTER ::INDEXED_FILTER(const int fileId) : FileId(fileId) {
-  name = GetName() + GetCollName(FileId);
-};
+INDEXED_FILTER ::INDEXED_FILTER(const int fileId) : FileId(fileId){};
 
-INDEXED_FILTER::INDEXED_FILTER(INDEXED_FILTER &Op) : FileId(Op.GetFileId()) {
-  name = Op.name;
-}
+INDEXED_FILTER::INDEXED_FILTER(INDEXED_FILTER &Op) : FileId(Op.GetFileId()) {}
 
-Cost *INDEXED_FILTER::FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) {
+Cost INDEXED_FILTER::FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) {
   float InputCard = Cat->GetCollProp(FileId)->Card;
   float Width = Cat->GetCollProp(FileId)->Width;
   INT_ARRAY *Indices = Cat->GetIndNames(FileId);
@@ -891,7 +855,7 @@ Cost *INDEXED_FILTER::FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogP
     data_cost = MIN(ceil(InputCard * Width), OutputCard) * (costModel->cpu_read() + costModel->io());
   }
 
-  Cost *Result = new Cost(index_cost + data_cost + pred_cost);
+  Cost Result(index_cost + data_cost + pred_cost);
 
   return (Result);
 }
@@ -414,9 +414,9 @@ Expression *Query::ParseExpr(char *&ExprStr) {
       }
     }
 
-    CONT *InitCont = new CONT(sort_prop, new Cost(-1), false);
-    // Make this the first context
-    CONT::vc.push_back(InitCont);
+    CONT *InitCont = new CONT(sort_prop, Cost::Infinite(), false);
+    // Make this the first context, held until the query is done
+    CONT::Hold(InitCont);
     assert(CONT::vc.size() == 1);
 
     free(OneElement);
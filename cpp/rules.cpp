@@ -5,10 +5,8 @@
 #include "../header/stdafx.h"
 #include "../header/tasks.h"
 
-#define NUMOFRULES 20  // Number of elements in the enum RULELABELS in rules.h
-
 // use to turn some rules on/off in the optimizer
-RuleSet::RuleSet() : RuleCount(NUMOFRULES) {
+RuleSet::RuleSet() : RuleCount(R_END) {
   int rule_count = 0;
 
   rule_set.resize(RuleCount);
@@ -72,8 +70,28 @@ RuleSet::RuleSet() : RuleCount(NUMOFRULES) {
 
   // DUMMY to PDUMMY
   rule_set[R_DUMMY_TO_PDUMMY] = new DUMMY_TO_PDUMMY();
+
+  // the join reordering rules without the masks of RS-B2
+  if (JoinRuleSet == RS_B0)
+    for (int Rule : {R_EQJOIN_COMMUTE, R_EQJOIN_LTOR, R_EQJOIN_RTOL, R_EXCHANGE}) rule_set[Rule]->set_mask({});
+
+  Index();
 };  // rule set
 
+void RuleSet::Index() {
+  for (auto &&rule : rule_set) {
+    if (rule == nullptr) continue;  // some rules may be turned off
+
+    bool Physical = rule->GetSubstitute()->GetOp()->is_physical();
+    Operator *Root = rule->GetOriginal()->GetOp();
+    for (int Op = 0; Op < (int)OPCODE::END; Op++) {
+      if (OpTraits[Op].Kind != OP_KIND::LOGICAL) continue;
+      if (Root->is_leaf() || (int)Root->GetOpcode() == Op)
+        (Physical ? ByOp[Op].Implement : ByOp[Op].Explore).push_back(rule);
+    }
+  }
+}  // RuleSet::Index
+
 RuleSet::~RuleSet() {
   for (auto &&rule : rule_set) delete rule;
 }
@@ -148,9 +166,9 @@ Expression *BINDERY::extract_expr() {
   }     // create leaf marked with group index
   else  // general invocation of new Expression
   {
-    // Top operator in the new Expression will be top operator in cur_expr.
-    // Get it.  (Probably could use patt_op here.)
-    Operator *op_arg = cur_expr->GetOp()->Clone();
+    // Top operator in the new Expression will be top operator in cur_expr,
+    // borrowed for as long as the binding lives.
+    Operator *op_arg = cur_expr->GetOp();
 
     // Need the arity of the top operator to construct inputs of new Expression
     int arity = op_arg->GetArity();
@@ -162,9 +180,9 @@ Expression *BINDERY::extract_expr() {
       for (int input_no = 0; input_no < arity; input_no++) subexpr.push_back(input[input_no]->extract_expr());
 
       // Put everything together for the result.
-      result = new Expression(op_arg, std::move(subexpr));
+      result = new Expression(op_arg, std::move(subexpr), true);
     } else
-      result = new Expression(op_arg, {});
+      result = new Expression(op_arg, {}, true);
 
   }  // general invocation of new Expression
 
@@ -257,7 +275,7 @@ bool BINDERY::advance() {
       case start:
 
         // is this expression unusable?
-        if (arity != patt_op->GetArity() || !(patt_op->GetNameId() == op_arg->GetNameId())) {
+        if (arity != patt_op->GetArity() || !(patt_op->GetOpcode() == op_arg->GetOpcode())) {
           state = finished;  // try next expression
           break;
         }
@@ -385,10 +403,10 @@ Expression *EQ_TO_LOOPS::next_substitute(Expression *before, PHYS_PROP *ReqdProp
 }
 // Is the plan a goner because an input is group pruned?
 bool EQ_TO_LOOPS::condition(Expression *before, MExression *mexpr, int ContextID) {
-  Cost inputs = *(Ssp->GetGroup(mexpr->GetInput(0))->GetLowerBd());
-  inputs += *(Ssp->GetGroup(mexpr->GetInput(1))->GetLowerBd());
+  Cost inputs = Ssp->GetGroup(mexpr->GetInput(0))->GetLowerBd();
+  inputs += Ssp->GetGroup(mexpr->GetInput(1))->GetLowerBd();
 
-  if (inputs >= *(CONT::vc[ContextID]->GetUpperBd())) return (false);
+  if (inputs >= CONT::vc[ContextID]->GetUpperBd()) return (false);
 
   return (true);
 }  // EQ_TO_LOOPS::condition
@@ -477,10 +495,10 @@ Expression *EQ_TO_MERGE::next_substitute(Expression *before, PHYS_PROP *ReqdProp
 
 // Is the plan a goner because an input is group pruned?
 bool EQ_TO_MERGE::condition(Expression *before, MExression *mexpr, int ContextID) {
-  Cost inputs = *(Ssp->GetGroup(mexpr->GetInput(0))->GetLowerBd());
-  inputs += *(Ssp->GetGroup(mexpr->GetInput(1))->GetLowerBd());
+  Cost inputs = Ssp->GetGroup(mexpr->GetInput(0))->GetLowerBd();
+  inputs += Ssp->GetGroup(mexpr->GetInput(1))->GetLowerBd();
 
-  if (inputs >= *(CONT::vc[ContextID]->GetUpperBd())) return (false);
+  if (inputs >= CONT::vc[ContextID]->GetUpperBd()) return (false);
 
   return (true);
 }  // EQ_TO_MERGE::condition
@@ -527,7 +545,7 @@ EQJOIN_COMMUTE::EQJOIN_COMMUTE()
                           {new Expression(new LeafOperator(1), {}), new Expression(new LeafOperator(0), {})})) {
   // set rule mask and index
   set_index(R_EQJOIN_COMMUTE);
-  set_mask(1 << R_EQJOIN_COMMUTE | 1 << R_EQJOIN_LTOR | 1 << R_EQJOIN_RTOL | 1 << R_EXCHANGE);
+  set_mask({R_EQJOIN_COMMUTE, R_EQJOIN_LTOR, R_EQJOIN_RTOL, R_EXCHANGE});
 
 }  // EQJOIN_COMMUTE::EQJOIN_COMMUTE
 
@@ -545,6 +563,39 @@ Expression *EQJOIN_COMMUTE::next_substitute(Expression *before, PHYS_PROP *ReqdP
   return result;
 }  // EQJOIN_COMMUTE::next_substitute
 
+/*
+ *	Cartesian products of the join associativity rules, limited by Cartesian.
+ *	They are seldom in a good plan, but allowing them multiplies the join
+ *	orders of a chain.
+ */
+
+// logical properties of the group bound to a leaf of a pattern
+static LOG_COLL_PROP *LeafProp(Expression *Leaf) {
+  return (LOG_COLL_PROP *)Ssp->GetGroup(((LeafOperator *)Leaf->GetOp())->GetGroup())->get_log_prop();
+}
+
+// tuples of the group of mexpr, which a Cartesian product at its root makes
+static double GroupCard(MExression *mexpr) {
+  return ((LOG_COLL_PROP *)Ssp->GetGroup(mexpr->GetGrpID())->get_log_prop())->Card;
+}
+
+// May a rule make a substitute whose largest Cartesian product has Card tuples, -1 for none?
+// Had is whether its original has a Cartesian product.
+static bool CartesianAllowed(bool Had, double Card) {
+  if (Card < 0) return true;
+  switch (Cartesian) {
+    case CART_ALLOW:
+      return true;
+    case CART_ORIGINAL:
+      return Had;
+    case CART_FORBID:
+      return false;
+    case CART_CARD:
+      return Card <= CartesianMaxCard;
+  }
+  return true;
+}
+
 /*
   Rule  EQJOIN (AB) C -> EQJOIN A (BC)
   ====  ============= == =============
@@ -566,7 +617,7 @@ EQJOIN_LTOR::EQJOIN_LTOR()
 {
   // set rule mask and index
   set_index(R_EQJOIN_LTOR);
-  set_mask(1 << R_EQJOIN_LTOR | 1 << R_EQJOIN_RTOL | 1 << R_EXCHANGE);
+  set_mask({R_EQJOIN_LTOR, R_EQJOIN_RTOL, R_EXCHANGE});
 
 }  // EQJOIN_LTOR::EQJOIN_LTOR
 
@@ -664,23 +715,25 @@ Expression *EQJOIN_LTOR::next_substitute(Expression *before, PHYS_PROP *ReqdProp
 
 }  // EQJOIN_LTOR::next_substitute
 
-/*
- *	Experimental Heuristic code to try to limit rule explosion
- *		This may eliminate useful join orders
- *		Global variable NoCart determines whether
- *		this condition function is ENABLED or DISABLED
- */
-
-// If we allow a non-Cartesian product to go to a Cartesian product, return true
-// If we do not allow a non-Cartesian product to go to a Cartesian product
-// Need to check:
-//	a. Whether original 2 joins       contained a cartesian product
-//	b. Whether the new  2 joins would contain   a cartesian product
-// Condition is:
-//	a || !b
-//
+// The predicates of the upper join on B move to the new lower join BC, the
+// others stay on top with those of AB.
 bool EQJOIN_LTOR::condition(Expression *before, MExression *mexpr, int ContextID) {
-  return true;
+  if (Cartesian == CART_ALLOW) return true;
+
+  EQJOIN *Op2 = (EQJOIN *)before->GetOp();
+  EQJOIN *Op1 = (EQJOIN *)before->GetInput(0)->GetOp();
+  Expression *AB = before->GetInput(0);
+  Schema *Bs_schema = LeafProp(AB->GetInput(1))->schema;
+
+  int nsize1 = 0;
+  for (int i = 0; i < Op2->size; i++)
+    if (Bs_schema->InSchema(Op2->lattrs[i])) nsize1++;
+  int nsize2 = Op1->size + Op2->size - nsize1;
+
+  double Card = -1;
+  if (nsize1 == 0) Card = LeafProp(AB->GetInput(1))->Card * LeafProp(before->GetInput(1))->Card;
+  if (nsize2 == 0) Card = max(Card, GroupCard(mexpr));
+  return CartesianAllowed(Op1->size == 0 || Op2->size == 0, Card);
 
 }  // EQJOIN_LTOR::condition
 
@@ -704,7 +757,7 @@ EQJOIN_RTOL::EQJOIN_RTOL()
                )                                                               // substitute
       ) {
   set_index(R_EQJOIN_RTOL);
-  set_mask(1 << R_EQJOIN_LTOR | 1 << R_EQJOIN_RTOL | 1 << R_EXCHANGE);
+  set_mask({R_EQJOIN_LTOR, R_EQJOIN_RTOL, R_EXCHANGE});
 }
 
 Expression *EQJOIN_RTOL::next_substitute(Expression *before, PHYS_PROP *ReqdProp) {
@@ -795,22 +848,25 @@ Expression *EQJOIN_RTOL::next_substitute(Expression *before, PHYS_PROP *ReqdProp
   return result;
 }  // EQJOIN_RTOL::next_substitute
 
-/*
- *	Very experimental code to try to limit rule explosion
- *		This may eliminate very useful join orders
- *		Go to the very end of this function to see if
- *		this condition function is ENABLED or DISABLED
- */
-// If we allow a non-Cartesian product to go to a Cartesian product, return true
-// If we do not allow a non-Cartesian product to go to a Cartesian product
-// Need to check:
-//	a. Whether original 2 joins       contained a cartesian product
-//	b. Whether the new  2 joins would contain   a cartesian product
-// Condition is:
-//	a || !b
-//
+// The predicates of the upper join on B move to the new lower join AB, the
+// others stay on top with those of BC.
 bool EQJOIN_RTOL::condition(Expression *before, MExression *mexpr, int ContextID) {
-  return true;
+  if (Cartesian == CART_ALLOW) return true;
+
+  EQJOIN *Op2 = (EQJOIN *)before->GetOp();
+  EQJOIN *Op1 = (EQJOIN *)before->GetInput(1)->GetOp();
+  Expression *BC = before->GetInput(1);
+  Schema *Bs_schema = LeafProp(BC->GetInput(0))->schema;
+
+  int nsize1 = 0;
+  for (int i = 0; i < Op2->size; i++)
+    if (Bs_schema->InSchema(Op2->rattrs[i])) nsize1++;
+  int nsize2 = Op1->size + Op2->size - nsize1;
+
+  double Card = -1;
+  if (nsize1 == 0) Card = LeafProp(before->GetInput(0))->Card * LeafProp(BC->GetInput(0))->Card;
+  if (nsize2 == 0) Card = max(Card, GroupCard(mexpr));
+  return CartesianAllowed(Op1->size == 0 || Op2->size == 0, Card);
 }  // EQJOIN_RTOL::condition
 
 // Cesar's EXCHANGE rule: (AxB)x(CxD) -> (AxC)x(BxD)
@@ -829,7 +885,7 @@ EXCHANGE::EXCHANGE()
                                                                 new Expression(new LeafOperator(3), {})})}))  // D
 {
   set_index(R_EXCHANGE);
-  set_mask(1 << R_EQJOIN_COMMUTE | 1 << R_EQJOIN_LTOR | 1 << R_EQJOIN_RTOL | 1 << R_EXCHANGE);
+  set_mask({R_EQJOIN_COMMUTE, R_EQJOIN_LTOR, R_EQJOIN_RTOL, R_EXCHANGE});
 }  // EXCHANGE::EXCHANGE
 
 Expression *EXCHANGE::next_substitute(Expression *before, PHYS_PROP *ReqdProp) {
@@ -964,22 +1020,37 @@ Expression *EXCHANGE::next_substitute(Expression *before, PHYS_PROP *ReqdProp) {
   return result;
 }  // EXCHANGE::next_substitute
 
-/*
- *	Very experimental code to try to limit rule explosion
- *		This may eliminate very useful join orders
- *		Go to the very end of this function to see if
- *		this condition function is ENABLED or DISABLED
- */
+// The predicates of the upper join between A and C move to the new join AC,
+// those between B and D to BD, and the others stay on top with those of AB
+// and CD.
+bool EXCHANGE::condition(Expression *before, MExression *mexpr, int ContextID) {
+  if (Cartesian == CART_ALLOW) return true;
+
+  EQJOIN *Op1 = (EQJOIN *)before->GetOp();
+  EQJOIN *Op2 = (EQJOIN *)before->GetInput(0)->GetOp();
+  EQJOIN *Op3 = (EQJOIN *)before->GetInput(1)->GetOp();
+  Expression *AB = before->GetInput(0);
+  Expression *CD = before->GetInput(1);
+  Schema *AAA = LeafProp(AB->GetInput(0))->schema;
+  Schema *CCC = LeafProp(CD->GetInput(0))->schema;
+
+  int nsize2 = 0, nsize3 = 0;
+  for (int i = 0; i < Op1->size; i++) {
+    bool InA = AAA->InSchema(Op1->lattrs[i]);
+    bool InC = CCC->InSchema(Op1->rattrs[i]);
+    if (InA && InC)
+      nsize2++;
+    else if (!InA && !InC)
+      nsize3++;
+  }
+  int nsize1 = Op1->size + Op2->size + Op3->size - nsize2 - nsize3;
 
-// If we allow a non-Cartesian product to go to a Cartesian product, return true
-// If we do not allow a non-Cartesian product to go to a Cartesian product
-// Need to check:
-//	a. Whether original 3 joins       contained a cartesian product
-//	b. Whether the new  3 joins would contain   a cartesian product
-// Condition is:
-//	a || !b
-//
-bool EXCHANGE::condition(Expression *before, MExression *mexpr, int ContextID) { return true; }  // EXCHANGE::condition
+  double Card = -1;
+  if (nsize2 == 0) Card = LeafProp(AB->GetInput(0))->Card * LeafProp(CD->GetInput(0))->Card;
+  if (nsize3 == 0) Card = max(Card, (double)LeafProp(AB->GetInput(1))->Card * LeafProp(CD->GetInput(1))->Card);
+  if (nsize1 == 0) Card = max(Card, GroupCard(mexpr));
+  return CartesianAllowed(Op1->size == 0 || Op2->size == 0 || Op3->size == 0, Card);
+}  // EXCHANGE::condition
 
 // Rule  SELECT  -> FILTER
 SELECT_TO_FILTER::SELECT_TO_FILTER()
@@ -1412,7 +1483,7 @@ PROJECT_THRU_SELECT::PROJECT_THRU_SELECT()
                                           {new Expression(new PROJECT(0, 0), {new Expression(new LeafOperator(0), {})}),
                                            new Expression(new LeafOperator(1), {})})})) {
   set_index(R_PROJECT_THRU_SELECT);
-  set_mask(1 << R_PROJECT_THRU_SELECT);
+  set_mask({R_PROJECT_THRU_SELECT});
 }
 
 Expression *PROJECT_THRU_SELECT::next_substitute(Expression *before, PHYS_PROP *ReqdProp) {
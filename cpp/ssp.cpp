@@ -1,15 +1,14 @@
 // ssp.cpp -  implementation of class SearchSpace
 
+#include "../header/joinenum.h"
 #include "../header/stdafx.h"
 #include "../header/tasks.h"
 
 #define SHRINK_INERVAL 10000
 #define MAX_AVAIL_MEM 40000000  // available memory bound to 50M
 
-SearchSpace::SearchSpace() : NewGrpID(-1) {
-  // initialize HashTbl to contain HashTableSize elements, each initially nullptr.
-  HashTbl = new MExression *[HtblSize];  // 8192
-  for (ub4 i = 0; i < HtblSize; i++) HashTbl[i] = nullptr;
+SearchSpace::SearchSpace() : NewGrpID(-1), QueuedMerges(0), Expired(false), ExpiredTask(0) {
+  for (int i = 0; i < Threads; i++) Arenas.push_back(new ARENA);
 }
 
 void SearchSpace::Init() {
@@ -18,29 +17,29 @@ void SearchSpace::Init() {
   // create the initial search space
   RootGID = NEW_GRPID;
   MExression *MExpr = CopyIn(Expr, RootGID);
+  MergeQueued();
 
   InitGroupNum = NewGrpID;
-  if (COVETrace)  // End Initializing Search Space
-    OutputCOVE << "EndInit\n" << endl;
+  COVE("EndInit\n");  // End Initializing Search Space
 }
 
 // free up memory
 SearchSpace::~SearchSpace() {
-  for (int i = 0; i < Groups.size(); i++) delete Groups[i];
-  delete[] HashTbl;
+  // merged ids alias a group with a smaller id, so visit them before it is deleted
+  for (int i = Groups.size() - 1; i >= 0; i--)
+    if (Groups[i] && Groups[i]->GetGroupID() == i) delete Groups[i];
+  Groups.clear();
+  for (auto &&group : MergedGroups) delete group;
+  for (auto &&mexpr : DroppedMExprs) delete mexpr;
+  for (auto &&arena : Arenas) delete arena;
 }
 
 string SearchSpace::DumpHashTable() {
   string os;
 
   os = "Hash Table BEGIN:\n";
-  int total = 0;
-  for (int i = 0; i < HtblSize; i++) {
-    for (MExression *mexpr = HashTbl[i]; mexpr != nullptr; mexpr = mexpr->GetNextHash(), total++)
-      os += "group:" + to_string(i) + ":" + to_string(mexpr->GetGrpID()) + "\t" + mexpr->Dump();
-    if (HashTbl[i]) os += "\n";
-  }
-  os += "Hash Table END, total " + to_string(total) + " mexpr\n";
+  os += HashTbl.Dump();
+  os += "Hash Table END, total " + to_string(HashTbl.size()) + " mexpr\n";
 
   return os;
 }
@@ -50,7 +49,7 @@ string SearchSpace::DumpChanged() {
   Group *group;
 
   for (int i = 0; i < Groups.size(); i++)
-    if (Groups[i]->is_changed()) {
+    if (Groups[i] && Groups[i]->GetGroupID() == i && Groups[i]->is_changed()) {
       group = Groups[i];
       os += group->Dump();
       os += "\n";
@@ -64,14 +63,14 @@ string SearchSpace::DumpChanged() {
 }
 
 void SearchSpace::Shrink() {
-  for (int i = InitGroupNum; i < Groups.size(); i++) ShrinkGroup(i);
+  for (int i = InitGroupNum; i < Groups.size(); i++)
+    if (Groups[i] && Groups[i]->GetGroupID() == i) ShrinkGroup(i);
 }
 
 void SearchSpace::ShrinkGroup(int group_no) {
   Group *group;
   MExression *mexpr;
   MExression *p;
-  MExression *prev;
   int DeleteCount = 0;
 
   group = Groups[group_no];
@@ -83,25 +82,13 @@ void SearchSpace::ShrinkGroup(int group_no) {
   // Shrink the logical mexpr
   // init the rule mark of the first mexpr to 0, means all rules are allowed
   mexpr = group->GetFirstLogMExpr();
-  mexpr->set_rule_mask(0);
+  mexpr->set_rule_mask(BIT_VECTOR());
 
   // delete all the mexpr except the first initial one
   mexpr = mexpr->GetNextMExpr();
 
   while (mexpr != nullptr) {
-    // maintain the hash link
-    // find my self in the appropriate hash bucket
-    ub4 hashval = mexpr->hash();
-    for (p = HashTbl[hashval], prev = nullptr; p != mexpr; prev = p, p = p->GetNextHash())
-      ;
-
-    assert(p == mexpr);
-    // link prev's next hash to next
-    if (prev)
-      prev->SetNextHash(mexpr->GetNextHash());
-    else
-      // the mexpr is the first in the bucket
-      HashTbl[hashval] = mexpr->GetNextHash();
+    HashTbl.Remove(mexpr);
 
     p = mexpr;
     mexpr = mexpr->GetNextMExpr();
@@ -115,21 +102,7 @@ void SearchSpace::ShrinkGroup(int group_no) {
   // update the lastlogmexpr = firstlogmexpr;
   group->SetLastLogMExpr(mexpr);
 
-  // Shrink the physcal mexpr
-  mexpr = group->GetFirstPhysMExpr();
-
-  while (mexpr != nullptr) {
-    p = mexpr;
-    mexpr = mexpr->GetNextMExpr();
-
-    delete p;
-    DeleteCount++;
-  }
-
-  mexpr = group->GetFirstPhysMExpr();
-  mexpr->SetNextMExpr(nullptr);
-  // update the lastlogmexpr = firstlogmexpr;
-  group->SetLastPhysMExpr(mexpr);
+  // the physical mexprs are kept, they are the plans of the winners
 
   group->set_changed(true);
   group->set_exploring(false);
@@ -145,6 +118,7 @@ string SearchSpace::Dump() {
 
   for (int i = 0; i < Groups.size(); i++) {
     group = Groups[i];
+    if (!group || group->GetGroupID() != i) continue;
     os += group->Dump();
     group->set_changed(false);
   }
@@ -153,90 +127,224 @@ string SearchSpace::Dump() {
 }
 
 void SearchSpace::FastDump() {
+  if (!TRACING(TRACE_DEBUG)) return;
+
   OutputFile << "SearchSpace Content: RootGID: " << RootGID << endl;
 
   for (int i = 0; i < Groups.size(); i++) {
+    if (!Groups[i] || Groups[i]->GetGroupID() != i) continue;
     OutputFile << Groups[i]->Dump() << endl;
     Groups[i]->set_changed(false);
   }
 }
 
-MExression *SearchSpace::FindDup(MExression &MExpr) {
-  int Arity = MExpr.GetArity();
+ARENA &SearchSpace::GetArena() { return *Arenas[TaskScheduler::worker()]; }
 
-  ub4 hashval = MExpr.hash();
-  MExression *prev = HashTbl[hashval];
+MExression *SearchSpace::FindDup(MExression &MExpr) { return HashTbl.FindOrInsert(MExpr); }
 
-  int BucketSize = 0;
-  if (!ForGlobalEpsPruning) OptStat->HashedMExpr++;
-  // try all expressions in the appropriate hash bucket
-  for (MExression *old = prev; old != nullptr; prev = old, old = old->GetNextHash(), BucketSize++) {
-    int input_no;
+MEXPR_TABLE::MEXPR_TABLE() {
+  for (auto &&Shard : Shards) {
+    Shard.Slots = new SLOT[SHARD_INIT_SIZE]();
+    Shard.Mask = SHARD_INIT_SIZE - 1;
+    Shard.Count = 0;
+  }
+}
 
-    // See if they have the same arities
-    if (old->GetArity() != Arity) {
-      goto not_a_duplicate;
-    }
+MEXPR_TABLE::~MEXPR_TABLE() {
+  for (auto &&Shard : Shards) delete[] Shard.Slots;
+}
+
+MExression *MEXPR_TABLE::FindOrInsert(MExression &MExpr) {
+  ub4 Hash = MExpr.hash();
+  SHARD &Shard = GetShard(Hash);
+  // other workers may be looking for duplicates in, or adding to, this shard
+  lock_guard<mutex> guard(Shard.Lock);
+
+  int Mask = Shard.Mask;
+  int Probe = 0;
+  // try the expressions from the home slot on, until an empty slot or one closer
+  // to its home than MExpr would be: MExpr would have taken that slot
+  for (int i = Home(Hash, Mask);; i = (i + 1) & Mask, Probe++) {
+    SLOT &Slot = Shard.Slots[i];
+    if (!Slot.MExpr || Distance(Slot.Hash, i, Mask) < Probe) break;
 
     // finding yourself does not constitute a duplicate
-    // compare pointers to see if EXPR_LISTs are the same
-    if (old == &MExpr) {
-      goto not_a_duplicate;
-    }
+    if (Slot.MExpr == &MExpr) return nullptr;
 
-    // compare the inputs
-    // Compare the actual group pointers for every input
-    for (input_no = Arity; --input_no >= 0;)
-      if (MExpr.GetInput(input_no) != old->GetInput(input_no)) {
-        PTRACE("Different at input " << input_no);
-        goto not_a_duplicate;
-      }
+    // "expr" is a duplicate of "old"
+    if (Slot.Hash == Hash && *Slot.MExpr == MExpr) {
+      if (!ForGlobalEpsPruning) OptStat->SeenProbe(Probe + 1);
+      return Slot.MExpr;
+    }
+  }
+  if (!ForGlobalEpsPruning) OptStat->SeenProbe(Probe + 1);
+
+  // no duplicate, insert into the table
+  if (8 * (Shard.Count + 1) > 7 * (Shard.Mask + 1)) Grow(Shard);
+  Place(Shard, {Hash, &MExpr});
+  Shard.Count++;
+
+  return nullptr;
+}  // MEXPR_TABLE::FindOrInsert
+
+// put Entry into its slot, displacing entries which are closer to their home
+void MEXPR_TABLE::Place(SHARD &Shard, SLOT Entry) {
+  int Mask = Shard.Mask;
+  int Probe = 0;
+  for (int i = Home(Entry.Hash, Mask);; i = (i + 1) & Mask, Probe++) {
+    SLOT &Slot = Shard.Slots[i];
+    if (!Slot.MExpr) {
+      Slot = Entry;
+      return;
+    }
 
-    // finally compare the Op
-    if (!(*(old->GetOp()) == MExpr.GetOp())) {
-      PTRACE("Different at Operator. " << old->Dump() << " : " << MExpr.Dump());
-      goto not_a_duplicate;
+    int SlotProbe = Distance(Slot.Hash, i, Mask);
+    if (SlotProbe < Probe) {
+      swap(Slot, Entry);
+      Probe = SlotProbe;
     }
+  }
+}
 
-    // "expr" is a duplicate of "old"
-    return (old);
+// double the slots of the shard
+void MEXPR_TABLE::Grow(SHARD &Shard) {
+  SLOT *OldSlots = Shard.Slots;
+  int OldSize = Shard.Mask + 1;
 
-  not_a_duplicate:
-    continue;  // check next expression in hash bucket
-  }            // try all expressions in the appropriate hash bucket
+  Shard.Slots = new SLOT[2 * OldSize]();
+  Shard.Mask = 2 * OldSize - 1;
+  for (int i = 0; i < OldSize; i++)
+    if (OldSlots[i].MExpr) Place(Shard, OldSlots[i]);
 
-  // no duplicate, insert into HashTable
-  if (prev == nullptr)
-    HashTbl[hashval] = &MExpr;
-  else
-    prev->SetNextHash(&MExpr);
+  delete[] OldSlots;
+  if (!ForGlobalEpsPruning) OptStat->HashResize++;
+}
+
+bool MEXPR_TABLE::Remove(MExression *MExpr) {
+  SHARD &Shard = GetShard(MExpr->hash());
+  lock_guard<mutex> guard(Shard.Lock);
+
+  int Mask = Shard.Mask;
+  int i = Home(MExpr->hash(), Mask);
+  // find my self in the shard
+  for (int Probe = 0; Shard.Slots[i].MExpr != MExpr; i = (i + 1) & Mask, Probe++)
+    if (!Shard.Slots[i].MExpr || Distance(Shard.Slots[i].Hash, i, Mask) < Probe) return false;
+
+  // shift the following entries back, until one which is at its home
+  for (int Next = (i + 1) & Mask; Shard.Slots[Next].MExpr && Distance(Shard.Slots[Next].Hash, Next, Mask) > 0;
+       i = Next, Next = (Next + 1) & Mask)
+    Shard.Slots[i] = Shard.Slots[Next];
 
-  if (!ForGlobalEpsPruning) {
-    if (OptStat->MaxBucket < BucketSize) OptStat->MaxBucket = BucketSize;
+  Shard.Slots[i].MExpr = nullptr;
+  Shard.Count--;
+  return true;
+}
+
+int MEXPR_TABLE::size() {
+  int Size = 0;
+  for (auto &&Shard : Shards) {
+    lock_guard<mutex> guard(Shard.Lock);
+    Size += Shard.Count;
   }
+  return Size;
+}
 
-  return (nullptr);
-}  // SearchSpace::FindDup
+int MEXPR_TABLE::capacity() {
+  int Capacity = 0;
+  for (auto &&Shard : Shards) {
+    lock_guard<mutex> guard(Shard.Lock);
+    Capacity += Shard.Mask + 1;
+  }
+  return Capacity;
+}
+
+string MEXPR_TABLE::Dump() {
+  string os;
+
+  for (int s = 0; s < HASH_SHARDS; s++) {
+    lock_guard<mutex> guard(Shards[s].Lock);
+    for (int i = 0; i <= Shards[s].Mask; i++) {
+      MExression *mexpr = Shards[s].Slots[i].MExpr;
+      if (mexpr)
+        os += "slot:" + to_string(s) + "." + to_string(i) + ":" + to_string(mexpr->GetGrpID()) + "\t" + mexpr->Dump() +
+              "\n";
+    }
+  }
+
+  return os;
+}
 
 // merge two groups when duplicate found in these two groups
 // means they should be the same group
 // always merge bigger group_no group to smaller one.
 
 int SearchSpace::MergeGroups(int group_no1, int group_no2) {
-  // MExression * mexpr;
+  Group *ToGroup = GetGroup(group_no1);
+  Group *FromGroup = GetGroup(group_no2);
 
-  int ToGid = group_no1;
-  int FromGid = group_no2;
+  // merged already
+  if (ToGroup == FromGroup) return ToGroup->GetGroupID();
 
   // always merge bigger group_no group to smaller one.
-  if (group_no1 > group_no2) {
-    ToGid = group_no2;
-    FromGid = group_no1;
+  if (ToGroup->GetGroupID() > FromGroup->GetGroupID()) swap(ToGroup, FromGroup);
+  int ToGid = ToGroup->GetGroupID();
+  int FromGid = FromGroup->GetGroupID();
+  PTRACE("merging group " << FromGid << " into group " << ToGid);
+  if (!ForGlobalEpsPruning) OptStat->MergedGroup++;
+
+  vector<MExression *> Parents;
+  Parents.swap(FromGroup->GetParents());
+
+  vector<OptimizerTask *> Woken;
+  ToGroup->Merge(FromGroup, Woken);
+
+  // the IDs of FromGroup, and of the groups merged into it, now name ToGroup
+  Groups.set(FromGid, ToGroup);
+  for (auto &&Gid : FromGroup->GetMergedIDs()) Groups.set(Gid, ToGroup);
+  MergedGroups.push_back(FromGroup);
+
+  // The mexprs with FromGroup as an input are hashed again.  One may now be
+  // a duplicate: of an mexpr in its own group, which is then dropped from the
+  // group, or of one in another group, which is equivalent to its own.
+  for (auto &&Parent : Parents) {
+    bool Hashed = HashTbl.Remove(Parent);
+    Parent->MergeInput(FromGid, ToGid);
+    if (!Hashed) continue;
+
+    MExression *DupMExpr = HashTbl.FindOrInsert(*Parent);
+    if (!DupMExpr) continue;
+    if (GetGroup(DupMExpr->GetGrpID()) != GetGroup(Parent->GetGrpID()))
+      QueueMerge(Parent->GetGrpID(), DupMExpr->GetGrpID());
+    else {
+      GetGroup(Parent->GetGrpID())->DropLogMExpr(Parent);
+      DroppedMExprs.push_back(Parent);
+    }
   }
 
+  PTasks.wake(Woken);
+
   return ToGid;
 }  // SearchSpace::MergeGroups
 
+void SearchSpace::QueueMerge(int group_no1, int group_no2) {
+  lock_guard<mutex> guard(MergeLock);
+  Merges.push_back(make_pair(group_no1, group_no2));
+  QueuedMerges++;
+}
+
+void SearchSpace::MergeQueued() {
+  while (MergesQueued()) {
+    pair<int, int> Merge;
+    {
+      lock_guard<mutex> guard(MergeLock);
+      Merge = Merges.back();
+      Merges.pop_back();
+    }
+    MergeGroups(Merge.first, Merge.second);
+    QueuedMerges--;
+  }
+}
+
 MExression *SearchSpace::CopyIn(Expression *Expr, int &GrpID) {
   Group *group;
   bool win = true;  // will we initialize nontrivial winners in this group?
@@ -272,17 +380,19 @@ MExression *SearchSpace::CopyIn(Expression *Expr, int &GrpID) {
         GrpID = DupMExpr->GetGrpID();
 
         // because the NewGrpID increases when constructing
-        // an MExression with NEW_GRPID, we need to decrease it
-        NewGrpID--;
+        // an MExression with NEW_GRPID, we need to decrease it,
+        // unless another worker has taken a newer ID since.
+        int UnusedGrpID = MExpr->GetGrpID();
+        NewGrpID.compare_exchange_strong(UnusedGrpID, UnusedGrpID - 1);
 
         delete MExpr;
         return nullptr;
       } else {
         // otherwise, i.e., GrpID != DupMExpr->GrpID
         // need do the merge
-        GrpID = MergeGroups(GrpID, DupMExpr->GetGrpID());
+        QueueMerge(GrpID, DupMExpr->GetGrpID());
         delete MExpr;
-        return nullptr;
+        return DupMExpr;
       }
     }  // if( DupMExpr != nullptr )
   }    // If the expression is logical
@@ -295,8 +405,7 @@ MExression *SearchSpace::CopyIn(Expression *Expr, int &GrpID) {
     // insert the new group into ssp
     GrpID = group->GetGroupID();
 
-    if (GrpID >= Groups.size()) Groups.resize(GrpID + 1);
-    Groups[GrpID] = group;
+    Groups.set(GrpID, group);
 
   } else {
     group = GetGroup(GrpID);
@@ -307,6 +416,10 @@ MExression *SearchSpace::CopyIn(Expression *Expr, int &GrpID) {
   // set the flag
   group->set_changed(true);
 
+  // the input groups keep track of the mexpr, to hash it again if they are merged
+  if (MExpr->GetOp()->is_logical())
+    for (int i = 0; i < MExpr->GetArity(); i++) GetGroup(MExpr->GetInput(i))->NewParent(MExpr);
+
   return MExpr;
 }  // SearchSpace::CopyIn
 
@@ -348,8 +461,7 @@ void SearchSpace::CopyOut(int GrpID, PHYS_PROP *PhysProp, int tabs) {
 
     OUTPUTN(tabs, os);
 
-    Cost *WinnerCost = ThisWinner->GetCost();
-    os = WinnerCost->Dump();
+    os = ThisWinner->GetCost().Dump();
 
     OUTPUT(os);
     PHYS_PROP *InputProp;
@@ -380,15 +492,14 @@ void SearchSpace::CopyOut(int GrpID, PHYS_PROP *PhysProp, int tabs) {
 
     WinnerOp = WinnerMExpr->GetOp();
     os = WinnerMExpr->Dump();
-    if (WinnerOp->GetName() == "QSORT") os += PhysProp->Dump();
+    if (WinnerOp->GetOpcode() == OPCODE::QSORT) os += PhysProp->Dump();
     os += ", Cost = ";
 
     if (!SingleLineBatch) OUTPUTN(tabs, os);
 
     // Extract cost of the winner, write it to the output string and
     //  print output string to window.
-    Cost *WinnerCost = ThisWinner->GetCost();
-    os = WinnerCost->Dump();
+    os = ThisWinner->GetCost().Dump();
 
     OUTPUT(os);
     if (SingleLineBatch)  // In this case we want only the total cost of the Winner
@@ -416,7 +527,7 @@ void SearchSpace::CopyOut(int GrpID, PHYS_PROP *PhysProp, int tabs) {
   }
 }  // SearchSpace::CopyOut()
 
-bool Group::firstplan = false;
+atomic<bool> Group::firstplan(false);
 
 /* bool Group::search_circle(CONT * C, bool & moresearch)
     {
@@ -452,8 +563,13 @@ MPlan not Null										  (2)			  (1)
 
 */
 bool Group::search_circle(CONT *C, bool &moreSearch) {
+  WINNER *Winner;
+  return search_circle(C, moreSearch, Winner);
+}
+
+bool Group::search_circle(CONT *C, bool &moreSearch, WINNER *&Winner) {
   // First search for a winner with property P.
-  WINNER *Winner = GetWinner(C->GetPhysProp());
+  Winner = GetWinner(C->GetPhysProp());
 
   // If there is no such winner, case (3)
   if (!Winner) {
@@ -461,18 +577,22 @@ bool Group::search_circle(CONT *C, bool &moreSearch) {
     return (false);
   }
 
-  assert(Winner->GetDone());  // This is not a recursive query
+  // This is not a recursive query, so a search in progress is run by another worker.
+  // Treat it as case (3); OptimizeGroupTask will wait for that search to complete.
+  if (!Winner->GetDone()) {
+    moreSearch = true;
+    return (false);
+  }
 
   // If there is a winner, denote its plan, cost components by M and WCost
   // Context cost component is CCost
   MExression *M = Winner->GetMPlan();
-  Cost *WCost = Winner->GetCost();
-  Cost *CCost = C->GetUpperBd();
-  assert(CCost);  // Did we get rid of all cruft?
+  Cost WCost = Winner->GetCost();
+  Cost CCost = C->GetUpperBd();
 
   if (M)  // there is a non-null winner
   {
-    if (*CCost >= *WCost)  // Real winner; CCost is less of a constraint.  Case (2)
+    if (CCost >= WCost)  // Real winner; CCost is less of a constraint.  Case (2)
     {
       moreSearch = false;
       return (true);
@@ -483,7 +603,7 @@ bool Group::search_circle(CONT *C, bool &moreSearch) {
     }
   } else  // Winner's Mplan is null.
   {
-    if (*WCost >= *CCost)  // Previous search failed and CCost is more of a constraint. (1)
+    if (WCost >= CCost)  // Previous search failed and CCost is more of a constraint. (1)
     {
       moreSearch = false;
       return (false);
@@ -495,94 +615,206 @@ bool Group::search_circle(CONT *C, bool &moreSearch) {
   }
 }
 
-WINNER *Group::GetWinner(PHYS_PROP *PhysProp) {
-  int Size = Winners.size();
-  for (int i = 0; i < Size; i++) {
-    PHYS_PROP *WinPhysProp = Winners[i]->GetPhysProp();
+Group::CIRCLE_ENTRY *Group::GetEntry(int PropId) {
+  for (CIRCLE_ENTRY *Entry = FirstEntry; Entry; Entry = Entry->Next)
+    if (Entry->PropId == PropId) return (Entry);
 
-    if (*WinPhysProp == *PhysProp) return (Winners[i]);
-  }
+  // No entry for this property
+  return (nullptr);
+}
+
+WINNER *Group::GetWinner(PHYS_PROP *PhysProp) {
+  CIRCLE_ENTRY *Entry = GetEntry(PhysProp->GetId());
 
   // No matching winner
-  return (nullptr);
+  if (!Entry) return (nullptr);
+
+  return (Entry->Winner);
+}
+
+vector<OptimizerTask *> &Group::GetWaiters(PHYS_PROP *ReqdProp) {
+  CIRCLE_ENTRY *Entry = GetEntry(ReqdProp->GetId());
+  assert(Entry);
+  return Entry->Waiters;
 }
 
-void Group::NewWinner(PHYS_PROP *ReqdProp, MExression *MExpr, Cost *TotalCost, bool done) {
-  if (COVETrace && MExpr)  // New Winner
+void Group::NewWinner(PHYS_PROP *ReqdProp, MExression *MExpr, const Cost &TotalCost, bool done) {
+  if (MExpr)  // New Winner
   {
-    OutputCOVE << "\tNewWin { " << to_string(MExpr->GetGrpID()) << " \"" << ReqdProp->Dump() << "\" "
-               << TotalCost->Dump() << " } { " << to_string(MExpr->GetGrpID()) << " " << MExpr << " \"" << MExpr->Dump()
-               << "\" " << (done ? "Done" : "Not Done") << " }" << endl;
+    COVE("\tNewWin { " << to_string(MExpr->GetGrpID()) << " \"" << ReqdProp->Dump() << "\" " << TotalCost.Dump()
+                       << " } { " << to_string(MExpr->GetGrpID()) << " " << MExpr << " \"" << MExpr->Dump() << "\" "
+                       << (done ? "Done" : "Not Done") << " }");
   }
 
+  lock_guard<recursive_mutex> guard(Lock);
   this->set_changed(true);
 
   // Seek winner with property ReqdProp in the winner's circle
-  for (int i = Winners.size(); --i >= 0;) {
-    if (*(Winners[i]->GetPhysProp()) == *ReqdProp) {
-      // Update the winner for the new search just begun
-      delete Winners[i];
-      Winners[i] = new WINNER(MExpr, ReqdProp, TotalCost, done);
-      return;
-    }
+  CIRCLE_ENTRY *Entry = GetEntry(ReqdProp->GetId());
+  if (Entry) {
+    // Replace the winner, tasks may still be reading the old one
+    WINNER *Winner = new WINNER(MExpr, Entry->PhysProp, TotalCost, done, Entry->Winner);
+    while (!Entry->Winner.compare_exchange_weak(Winner->Prev, Winner))
+      ;
+    return;
   }
 
-  // No matching winner for this property
-  Winners.push_back(new WINNER(MExpr, ReqdProp, TotalCost, done));
+  // No matching winner for this property.  The entry keeps the canonical
+  // property, as the context holding ReqdProp goes with its search.
+  Entry = new CIRCLE_ENTRY;
+  Entry->PropId = ReqdProp->GetId();
+  Entry->PhysProp = ReqdProp->Canonical();
+  Entry->Winner = new WINNER(MExpr, Entry->PhysProp, TotalCost, done);
+  Entry->Next = nullptr;
+  if (LastEntry)
+    LastEntry->Next = Entry;
+  else
+    FirstEntry = Entry;
+  LastEntry = Entry;
 
   return;
 }
 
-bool Group::CheckWinnerDone() {
-  // Search Winner's circle.  If there is a winner done, return true
+bool Group::ImproveWinner(PHYS_PROP *ReqdProp, MExression *MExpr, const Cost &TotalCost) {
+  CIRCLE_ENTRY *Entry = GetEntry(ReqdProp->GetId());
+  assert(Entry);  // the search should have initialized a winner
+
+  WINNER *Old = Entry->Winner;
+  WINNER *Winner = nullptr;
+  // While there is no non-null winner, or it is more expensive than MExpr
+  while (!Old->GetMPlan() || TotalCost < Old->GetCost()) {
+    if (!Winner)
+      Winner = new WINNER(MExpr, Entry->PhysProp, TotalCost, false, Old);
+    else
+      Winner->Prev = Old;
+
+    // On failure another task has replaced the winner; Old is now that winner
+    if (Entry->Winner.compare_exchange_weak(Old, Winner)) {
+      COVE("\tNewWin { " << to_string(MExpr->GetGrpID()) << " \"" << ReqdProp->Dump() << "\" " << TotalCost.Dump()
+                         << " } { " << to_string(MExpr->GetGrpID()) << " " << MExpr << " \"" << MExpr->Dump()
+                         << "\" Not Done }");
+      this->set_changed(true);
+      return (true);
+    }
+  }
+
+  // Leave the cheaper winner alone
+  if (Winner) {
+    Winner->Prev = nullptr;
+    delete Winner;
+  }
+  return (false);
+}
+
+void Group::SetWinnerDone(PHYS_PROP *ReqdProp, bool done) {
+  lock_guard<recursive_mutex> guard(Lock);
+  CIRCLE_ENTRY *Entry = GetEntry(ReqdProp->GetId());
+  assert(Entry);
 
-  int Size = Winners.size();
+  WINNER *Old = Entry->Winner;
+  while (Old->GetDone() != done) {
+    WINNER *Winner = new WINNER(Old->GetMPlan(), Old->GetPhysProp(), Old->GetCost(), done, Old);
+    if (Entry->Winner.compare_exchange_strong(Old, Winner)) {
+      this->set_changed(true);
+      return;
+    }
 
-  for (int i = 0; i < Size; i++) {
-    if (Winners[i]->GetDone()) return (true);
+    Winner->Prev = nullptr;
+    delete Winner;
+  }
+}
+
+bool Group::CheckWinnerDone() {
+  // Search Winner's circle.  If there is a winner done, return true
+  for (CIRCLE_ENTRY *Entry = FirstEntry; Entry; Entry = Entry->Next) {
+    if (Entry->Winner.load()->GetDone()) return (true);
   }
 
   // No winner is done
   return (false);
 }
 
-WINNER::WINNER(MExression *MExpr, PHYS_PROP *PhysProp, Cost *cost, bool done)
-    : cost(cost), MPlan((MExpr == nullptr) ? nullptr : (new MExression(*MExpr))), PhysProp(PhysProp), Done(done){};
+void *WINNER::operator new(size_t size) { return Ssp->GetArena().alloc(size); }
+
+void WINNER::operator delete(void *p, size_t size) { Ssp->GetArena().free(p, size); }
 
-int TaskNo;
-int Memo_M_Exprs;
+WINNER::WINNER(MExression *MExpr, PHYS_PROP *PhysProp, const Cost &cost, bool done, WINNER *Prev)
+    : cost(cost),
+      MPlan(MExpr),
+      PhysProp(PhysProp),
+      Done(done),
+      Prev(Prev){};
 
-void SearchSpace::optimize() {
+WINNER::~WINNER() {
+  // delete the winners this one replaced, without recursing down the chain
+  while (Prev) {
+    WINNER *Older = Prev;
+    Prev = Older->Prev;
+    Older->Prev = nullptr;
+    delete Older;
+  }
+}
+
+atomic<int> TaskNo;
+atomic<int> Memo_M_Exprs;
+
+void SearchSpace::optimize(const Cost &UpperBd) {
   Ssp->GetGroup(0)->setfirstplan(false);
 
-  // Create initial context, with no requested properties, infinite upper bound,
-  //  zero lower bound, not yet done.  Later this may be specified by user.
+  // Create initial context, with no requested properties, the upper bound
+  //  given, zero lower bound, not yet done.
   if (CONT::vc.size() == 0) {
-    CONT *InitCont = new CONT(new PHYS_PROP(any), new Cost(-1), false);
-    // Make this the first context
-    CONT::vc.push_back(InitCont);
+    CONT *InitCont = new CONT(new PHYS_PROP(any), UpperBd, false);
+    // Make this the first context, held until the query is done
+    CONT::Hold(InitCont);
   }
 
-  // start optimization with root group, 0th context, parent task of zero.
-  PTasks.push(new OptimizeGroupTask(Ssp->GetGroup(RootGID), 0, 0, true));
+  Deadline = chrono::steady_clock::now() + chrono::milliseconds(DeadlineMs);
 
-  while (!PTasks.empty()) {
-    TaskNo++;
-    PTRACE("--------------------------Starting task " << TaskNo << "-----------------------------");
+  // copy in the join orders of the join blocks, so the rules need not find them
+  JoinEnumerator::EnumerateAll(RootGID);
+  MergeQueued();
 
-    OptimizerTask *task = PTasks.pop();
-    task->perform();
-
-    PTRACE("------------------ SearchSpace after task " << TaskNo << ": ");
-    OutputFile << DumpChanged() << endl;
+  // start optimization with root group, 0th context, parent task of zero.
+  PTasks.run(new OptimizeGroupTask(Ssp->GetGroup(RootGID), 0, 0), Threads);
+  MergeQueued();
+  if (ForGlobalEpsPruning) return;  // a first pass only wants the cost of its plan
 
-    PTRACE("------------------ OPEN after task " << TaskNo << ":");
-    OutputFile << PTasks.Dump() << endl;
-  }
-  OutputFile << endl << DumpHashTable() << endl;
+  OUTPUT_DEBUG(endl << DumpHashTable());
 
   PTRACE("Optimizing completed: " << TaskNo << " tasks\n");
   OUTPUT("TotalTask : " << TaskNo);
+  OUTPUT("Threads : " << Threads);
   OUTPUT("TotalMExpr in MEMO: " << Memo_M_Exprs);
+  OptStat->HashEntries = HashTbl.size();
+  OptStat->LogProps = LogProps.size();
+  OptStat->SharedLogProps = LogProps.shared();
+  OptStat->HashSlots = HashTbl.capacity();
   OUTPUT(OptStat->Dump());
+
+  if (DeadlineMs > 0) {
+    int Explored = 0, Total = 0;
+    for (int i = 0; i < Groups.size(); i++) {
+      if (!Groups[i] || Groups[i]->GetGroupID() != i) continue;
+      Total++;
+      if (Groups[i]->is_explored() || Groups[i]->is_optimized()) Explored++;
+    }
+    int Rules = OptStat->FiredRule + OptStat->SkippedRule;
+    OUTPUT("Deadline : " << DeadlineMs << "ms, "
+                         << (Expired ? "reached at task " + to_string(ExpiredTask) : string("not reached")));
+    OUTPUT("Search Space Covered : " << (Rules ? 100.0 * OptStat->FiredRule / Rules : 100.0) << "% of rule applications, "
+                                     << Explored << " of " << Total << " groups explored");
+  }
+}
+
+bool SearchSpace::PastDeadline() {
+  if (DeadlineMs <= 0) return false;
+  if (Expired) return true;
+  if (chrono::steady_clock::now() < Deadline) return false;
+
+  if (!Expired.exchange(true)) {
+    ExpiredTask = TaskNo;
+    PTRACE("Deadline passed at task " << ExpiredTask << ", no more transformations");
+  }
+  return true;
 }
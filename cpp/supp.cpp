@@ -143,27 +143,6 @@ bool EqualArray(int *array1, int *array2, int size) {
   return true;
 }
 
-// **********  BIT_VECTOR function **********
-void bit_on(BIT_VECTOR &bit_vect, int rule_no)  // Turn this bit on
-{
-  unsigned int n = (1 << rule_no);
-
-  assert(rule_no >= 0 && rule_no < 32);
-  // assert( (bit_vect & n) == 0 );  //Be sure this bit is off!
-
-  bit_vect = bit_vect | n;
-};
-
-bool is_bit_off(BIT_VECTOR bit_vect, int rule_no)  // Is this bit off?
-{
-  unsigned int n = (1 << rule_no);
-
-  if ((bit_vect & n) == 0)
-    return (true);
-  else
-    return (false);
-};
-
 //*************  Function for KEYS_SET class  ************
 //##ModelId=3B0C085F0395
 bool KEYS_SET::AddKey(string CollName, string KeyName) {
@@ -382,37 +361,29 @@ string Attribute::attrDump() { return GetAttName(AttId); }
 string Attribute::DumpCOVE() { return GetAttName(AttId) + ":" + to_string((int)CuCard) + "  "; };
 
 // Schema function
-bool Schema::AddAttr(int Index, Attribute *attr) {
+bool Schema::AddAttr(int Index, const Attribute &attr) {
   assert(Index < Size);
   Attrs[Index] = attr;
+  AttSet.set(attr.AttId);
 
   return true;
 }
 
 // return true if the relname.attname is in the schema
-bool Schema::InSchema(int AttId) {
-  int i = 0;
-  for (i = 0; i < Size; i++)
-    if (AttId == Attrs[i]->AttId) break;
-
-  if (i < Size)
-    return true;
-  else
-    return false;
-}
+bool Schema::InSchema(int AttId) { return AttSet.test(AttId); }
 
 // max cucard of each tables in the schema
 float Schema::GetTableMaxCuCard(int TableIndex) {
   float Max = 0;
 
   for (int i = 0; i < Size; i++) {
-    int CollId = GetCollId(Attrs[i]->AttId);
+    int CollId = GetCollId(Attrs[i].AttId);
     // 0 is used for attr generated by rangevar(e.g. func_op(<A.X> as sum) )
     // along the query tree, they are not from any table
     if (CollId == 0) return Max;
     if (CollId == TableId[TableIndex])  // the attr is from the table
     {
-      if (Max < Attrs[i]->CuCard) Max = Attrs[i]->CuCard;
+      if (Max < Attrs[i].CuCard) Max = Attrs[i].CuCard;
     }
   }
 
@@ -438,14 +409,12 @@ Schema *Schema::projection(int *attrs, int size) {
   for (int i = 0; i < size; i++) {
     int index = 0;
     for (index = 0; index < this->Size; index++) {
-      if (attrs[i] == this->Attrs[index]->AttId) {
+      if (attrs[i] == this->Attrs[index].AttId) {
         // has attr op in projection list -- add it in:
-        // Attribute * Attr = new Attribute(Attrs[index]->AttId , Attrs[index]->CuCard, -1, -1);
-        Attribute *Attr = new Attribute(*Attrs[index]);
-        new_schema->AddAttr(i, Attr);
+        new_schema->AddAttr(i, Attrs[index]);
 
         // get the table info for the new schema
-        int CollId = GetCollId(Attr->AttId);
+        int CollId = GetCollId(Attrs[index].AttId);
 
         for (int i = 0; i < new_schema->TableNum; i++)
           if (CollId == new_schema->TableId[i]) break;
@@ -480,48 +449,52 @@ Schema *Schema::UnionSchema(Schema *other) {
   for (i = 0; i < this->TableNum; i++) schema->TableId[i] = this->TableId[i];
   for (j = 0; j < other->TableNum; j++) schema->TableId[i + j] = other->TableId[j];
 
-  Attribute *Attr;
-  for (i = 0; i < LSize; i++) {
-    // from cascade
-    // we calculate new cucards, in a very very crude way.
-    // New cucards are half the old ones :)
-    float CuCard = (*this)[i]->CuCard;
-    CuCard = (CuCard != -1) ? CuCard / 2 : -1;
-    float min = (*this)[i]->Min;
-    float max = (*this)[i]->Max;
-    Attr = new Attribute((*this)[i]->AttId, CuCard, min, max);
-    schema->AddAttr(i, Attr);
-  }
+  // the attributes are copied in place, and their set is the union of both sets
+  Attribute *Attr = schema->Attrs;
+  for (i = 0; i < LSize; i++) Attr[i] = Attrs[i];
+  for (j = 0; j < RSize; j++) Attr[i + j] = other->Attrs[j];
+  schema->AttSet = AttSet;
+  schema->AttSet |= other->AttSet;
 
-  for (j = 0; j < RSize; j++) {
-    // from cascade
-    // we calculate new cucards, in a very very crude way.
-    // New cucards are half the old ones :)
-    float CuCard = (*other)[j]->CuCard;
-    CuCard = (CuCard != -1) ? CuCard / 2 : -1;
-    float min = (*other)[j]->Min;
-    float max = (*other)[j]->Max;
-    Attr = new Attribute((*other)[j]->AttId, CuCard, min, max);
-    schema->AddAttr(i + j, Attr);
-  }
+  // from cascade
+  // we calculate new cucards, in a very very crude way.
+  // New cucards are half the old ones :)
+  for (i = 0; i < LSize + RSize; i++)
+    if (Attr[i].CuCard != -1) Attr[i].CuCard /= 2;
 
   return schema;
 }
 
 // return true if contains all the keys
 bool Schema::Contains(KEYS_SET *Keys) {
-  for (int i = 0; i < Keys->GetSize(); i++) {
-    if (!InSchema((*Keys)[i])) return false;
-  }
+  for (int i = 0; i < Keys->GetSize(); i++)
+    if (!AttSet.test((*Keys)[i])) return false;
 
   return true;
 
 }  // Contains
 
+bool Schema::operator==(Schema &other) {
+  if (Size != other.Size || TableNum != other.TableNum) return false;
+  for (int i = 0; i < Size; i++)
+    if (Attrs[i].AttId != other.Attrs[i].AttId || Attrs[i].CuCard != other.Attrs[i].CuCard ||
+        Attrs[i].Min != other.Attrs[i].Min || Attrs[i].Max != other.Attrs[i].Max)
+      return false;
+  for (int i = 0; i < TableNum; i++)
+    if (TableId[i] != other.TableId[i]) return false;
+  return true;
+}
+
+// the statistics are left out, the attrs almost always tell schemas apart
+ub4 Schema::hash() {
+  ub4 hashval = lookup2(Size, 0);
+  for (int i = 0; i < Size; i++) hashval = lookup2(Attrs[i].AttId, hashval);
+  return hashval;
+}
+
 // free up memory
 Schema::~Schema() {
-  for (int i = 0; i < Size; i++) delete Attrs[i];
-  delete Attrs;
+  delete[] Attrs;
 
   delete[] TableId;
 }
@@ -530,7 +503,7 @@ Schema::~Schema() {
 string Schema::Dump() {
   string os;
   for (int i = 0; i < Size; i++) {
-    os += (*(Attrs[i])).Dump();
+    os += Attrs[i].Dump();
     os += "\n";
   }
   return os;
@@ -538,7 +511,7 @@ string Schema::Dump() {
 
 string Schema::DumpCOVE() {
   string os;
-  for (int i = 0; i < Size; i++) os += (*(Attrs[i])).DumpCOVE();
+  for (int i = 0; i < Size; i++) os += Attrs[i].DumpCOVE();
   return os;
 }
 
@@ -549,8 +522,8 @@ KEYS_SET *Schema::AttrStore() {
   for (int i = 0; i < GetSize(); i++) {
     // os += (*(Attrs[i])).attrDump();
     // PTRACE("attribute dump is %s", (*(Attrs[i])).attrDump());
-    if ((IntOrdersSet.ContainKey(Attrs[i]->AttId)) == true) {
-      largeKeySet->AddKey(Attrs[i]->AttId);
+    if ((IntOrdersSet.ContainKey(Attrs[i].AttId)) == true) {
+      largeKeySet->AddKey(Attrs[i].AttId);
     }
   }
   return largeKeySet;
@@ -579,6 +552,70 @@ string LOG_COLL_PROP::DumpCOVE() {
   return to_string((int)Card) + " " + to_string(UCard) + " { " + (*schema).DumpCOVE() + " }";
 };
 
+ub4 LOG_COLL_PROP::hash() {
+  ub4 hashval = schema->hash();
+  hashval = lookup2((ub4)Card, hashval);
+  for (int i = 0; i < CandidateKey->GetSize(); i++) hashval = lookup2((*CandidateKey)[i], hashval);
+  return lookup2(FKeyList.size(), hashval);
+}
+
+bool LOG_COLL_PROP::Equal(LOG_PROP *other) {
+  LOG_COLL_PROP *Other = dynamic_cast<LOG_COLL_PROP *>(other);
+  if (Other == NULL || Card != Other->Card || UCard != Other->UCard) return false;
+  if (!(*CandidateKey == *Other->CandidateKey) || FKeyList != Other->FKeyList) return false;
+  return *schema == *Other->schema;
+}
+
+ub4 LOG_ITEM_PROP::hash() {
+  ub4 hashval = lookup2((ub4)CuCard, 0);
+  for (int i = 0; i < FreeVars.GetSize(); i++) hashval = lookup2(FreeVars[i], hashval);
+  return hashval;
+}
+
+bool LOG_ITEM_PROP::Equal(LOG_PROP *other) {
+  LOG_ITEM_PROP *Other = dynamic_cast<LOG_ITEM_PROP *>(other);
+  return Other != NULL && Max == Other->Max && Min == Other->Min && CuCard == Other->CuCard &&
+         Selectivity == Other->Selectivity && FreeVars == Other->FreeVars;
+}
+
+/* ============  LOG_PROP_TABLE  ============ */
+
+LOG_PROP *LOG_PROP_TABLE::Intern(LOG_PROP *Prop) {
+  ub4 Hash = Prop->hash();
+  lock_guard<mutex> guard(Lock);
+  auto Range = Props.equal_range(Hash);
+  for (auto It = Range.first; It != Range.second; ++It)
+    if (It->second->Equal(Prop)) {
+      delete Prop;
+      Shared++;
+      return It->second;
+    }
+  Props.emplace(Hash, Prop);
+  return Prop;
+}
+
+LOG_PROP_TABLE::~LOG_PROP_TABLE() {
+  for (auto &&Entry : Props) delete Entry.second;
+}
+
+/* ============  SYMBOL_TABLE  ============ */
+
+int SYMBOL_TABLE::intern(const string &Name) {
+  auto It = Ids.find(Name);
+  if (It != Ids.end()) return It->second;
+
+  int Id = Names.size();
+  Names.push_back(Name);
+  Ids.emplace(Names.back(), Id);
+  return Id;
+}
+
+void SYMBOL_TABLE::clear() {
+  Ids.clear();
+  Names.clear();
+  intern("");
+}
+
 // misc functions
 
 // Get Collection id from name, using CollTable dictionary
@@ -590,96 +627,37 @@ int GetCollId(int AttId) {
 }
 
 // Get the ids from names
-int GetCollId(string CollName) {
-  int Size = CollTable.size();
-  int i = 0;
-  for (i = 0; i < Size; i++)
-    if (CollName == CollTable[i]) break;
-
-  if (i == Size) CollTable.push_back(CollName);
-
-  return i;
-}
+int GetCollId(const string &CollName) { return CollTable.intern(CollName); }
 
 // Get Att id from name, using AttTable dictionary
 // If not present, add full Att name to AttTable, entry to AttCollTable
+int GetAttId(const string &CollName, const string &AttName) {
+  int AttId = AttTable.intern(CollName + "." + AttName);
+  if (AttId == AttCollTable.size()) AttCollTable.push_back(GetCollId(CollName));
 
-int GetAttId(string CollName, string AttName) {
-  string Name = CollName + "." + AttName;
-  int Size = AttTable.size();
-  int i = 0;
-  for (i = 0; i < Size; i++) {
-    if (Name == AttTable[i]) break;
-  }
-
-  if (i == Size)  // the entry not exist, new it
-  {
-    AttTable.push_back(Name);
-    AttCollTable.push_back(GetCollId(CollName));
-  }
-
-  return i;
+  return AttId;
 }
 
-int GetAttId(string Name) {
+int GetAttId(const string &Name) {
   int pos = Name.find('.');
   assert(pos != -1);
 
-  int Size = AttTable.size();
-  int i = 0;
-  for (int i = 0; i < Size; i++)
-    if (Name == AttTable[i]) break;
-
-  if (i == Size)  // the entry not exist, new it
-  {
-    AttTable.push_back(Name);
-    string CollName = Name.substr(0, pos);
-    AttCollTable.push_back(GetCollId(CollName));
-  }
+  int AttId = AttTable.intern(Name);
+  if (AttId == AttCollTable.size()) AttCollTable.push_back(GetCollId(Name.substr(0, pos)));
 
-  return i;
+  return AttId;
 }
 
-// Get the ids from names
-int GetIndId(string CollName, string IndName) {
-  string Name = CollName + "." + IndName;
-  int i = 0;
-  int Size = IndTable.size();
-  for (int i = 0; i < Size; i++)
-    if (Name == IndTable[i]) break;
-
-  if (i == Size)  // the entry not exist, new it
-    IndTable.push_back(Name);
+int GetIndId(const string &CollName, const string &IndName) { return IndTable.intern(CollName + "." + IndName); }
 
-  return i;
-}
-
-// Get the ids from names
-int GetBitIndId(string CollName, string BitIndName) {
-  string Name = CollName + "." + BitIndName;
-  int Size = BitIndTable.size();
-  int i = 0;
-  for (int i = 0; i < Size; i++)
-    if (Name == BitIndTable[i]) break;
-
-  if (i == Size)  // the entry not exist, new it
-    BitIndTable.push_back(Name);
-
-  return i;
+int GetBitIndId(const string &CollName, const string &BitIndName) {
+  return BitIndTable.intern(CollName + "." + BitIndName);
 }
 
 // Get the names from Ids
-string GetCollName(int CollId) {
-  if (CollId == 0) return "";
-  assert(CollId < CollTable.size());
-  return CollTable[CollId];
-}
+const string &GetCollName(int CollId) { return CollTable.name(CollId); }
 
-string GetAttName(int AttId) {
-  if (AttId == 0) return "";
-  assert(AttId < AttTable.size());
-  return AttTable[AttId];
-}
+const string &GetAttName(int AttId) { return AttTable.name(AttId); }
 
 // Transform A.B to B
 string TruncName(string AttName) {
@@ -689,17 +667,9 @@ string TruncName(string AttName) {
   return p;
 }
 
-string GetIndName(int IndId) {
-  if (IndId == 0) return "";
-  assert(IndId < IndTable.size());
-  return IndTable[IndId];
-}
+const string &GetIndName(int IndId) { return IndTable.name(IndId); }
 
-string GetBitIndName(int BitIndId) {
-  if (BitIndId == 0) return "";
-  assert(BitIndId < BitIndTable.size());
-  return BitIndTable[BitIndId];
-}
+const string &GetBitIndName(int BitIndId) { return BitIndTable.name(BitIndId); }
 
 DOM_TYPE atoDomain(char *p) {
   if (strcmp(p, "string_t") == 0) return string_t;
@@ -763,7 +733,7 @@ string Trim(string PathName) { return PathName; };
 
 // skip the blank space
 char *SkipSpace(char *p) {
-  while (*p == ' ' || *p == '\t') p++;
+  while (*p == ' ' || *p == '\t' || *p == '\r') p++;
   return p;
 }
 
@@ -786,13 +756,13 @@ void parseString(char *p) {
 }
 
 //=============  PHYS_PROP Methods  ===================
-PHYS_PROP::PHYS_PROP(KEYS_SET *Keys, ORDER Order) : Keys(Keys), Order(Order){};
+PHYS_PROP::PHYS_PROP(KEYS_SET *Keys, ORDER Order) : Keys(Keys), Order(Order), Id(-1){};
 
 // a constructor for ANY property
-PHYS_PROP::PHYS_PROP(ORDER Order) : Keys(NULL), Order(Order) { assert(Order == any); }
+PHYS_PROP::PHYS_PROP(ORDER Order) : Keys(NULL), Order(Order), Id(0) { assert(Order == any); }
 
 PHYS_PROP::PHYS_PROP(PHYS_PROP &other)
-    : Keys(other.Order == any ? NULL : new KEYS_SET(*(other.Keys))), Order(other.Order) {
+    : Keys(other.Order == any ? NULL : new KEYS_SET(*(other.Keys))), Order(other.Order), Id(other.Id.load()) {
   if (Order == sorted) {
     assert(other.KeyOrder.size() == other.Keys->GetSize());
     for (int i = 0; i < other.KeyOrder.size(); i++) this->KeyOrder.push_back(other.KeyOrder[i]);
@@ -802,6 +772,7 @@ PHYS_PROP::PHYS_PROP(PHYS_PROP &other)
 void PHYS_PROP::Merge(PHYS_PROP &other) {
   assert(Order == other.Order);  // only idential orders can be merge
 
+  Id = -1;
   Keys->Merge(*(other.Keys));
   if (Order == sorted) {
     for (int i = 0; i < other.KeyOrder.size(); i++) this->KeyOrder.push_back(other.KeyOrder[i]);
@@ -879,29 +850,229 @@ void PHYS_PROP::bestKey() {
   KeyOrder[0] = KeyOrder[win];
   KeyOrder.resize(1);
   delete result;
+  Id = -1;
+}
+
+int PHYS_PROP::GetId() {
+  int MyId = Id;
+  if (MyId < 0) Id = MyId = Table.Intern(this);
+  return MyId;
+}
+
+PHYS_PROP *PHYS_PROP::Canonical() { return Table[GetId()]; }
+
+ub4 PHYS_PROP::hash() {
+  ub4 Hash = Order;
+  if (Order == any) return Hash;
+  for (int i = 0; i < Keys->GetSize(); i++) Hash = Hash * 31 + (*Keys)[i];
+  for (int i = 0; i < KeyOrder.size(); i++) Hash = Hash * 31 + KeyOrder[i];
+  return Hash;
+}
+
+PHYS_PROP_TABLE PHYS_PROP::Table;
+
+//=============  PHYS_PROP_TABLE Methods  ===================
+
+PHYS_PROP_TABLE::PHYS_PROP_TABLE() {
+  PHYS_PROP *Any = new PHYS_PROP(any);
+  Ids.emplace(Any->hash(), Props.push_back(Any));
+}
+
+PHYS_PROP_TABLE::~PHYS_PROP_TABLE() {
+  for (int i = 0; i < Props.size(); i++) delete Props[i];
+}
+
+int PHYS_PROP_TABLE::Intern(PHYS_PROP *Prop) {
+  ub4 Hash = Prop->hash();
+  lock_guard<mutex> guard(Lock);
+  auto Range = Ids.equal_range(Hash);
+  for (auto It = Range.first; It != Range.second; ++It)
+    if (*Props[It->second] == *Prop) return It->second;
+
+  PHYS_PROP *Copy = new PHYS_PROP(*Prop);
+  int Id = Props.push_back(Copy);
+  Copy->Id = Id;
+  Ids.emplace(Hash, Id);
+  return Id;
 }
 
 //=============  CONT Methods  ===================
 
-CONT::CONT(PHYS_PROP *RP, Cost *U, bool D) : ReqdPhys(RP), UpperBd(U), Finished(false) {
+CONT::CONT(PHYS_PROP *RP, Cost U, bool D) : ReqdPhys(RP), UpperBd(U), Finished(false), Users(0), GroupID(-1) {
   // If the Physical Property has >1 attribute, use only the most selective attribute
   if (RP && (RP->GetKeysSet()) && (RP->GetKeysSet()->GetSize() > 1))
     // RP-> SetKeysSet( RP->GetKeysSet() -> best());
     RP->bestKey();
 };
 
-vector<CONT *> CONT::vc;
+void CONT::SetUpperBound(const Cost &NewUB) {
+  // On failure another task has changed the bound; Bound is now that bound
+  Cost Bound = UpperBd;
+  while (NewUB < Bound && !UpperBd.compare_exchange_weak(Bound, NewUB))
+    ;
+}
 
-//=============  Cost Methods  ===================
+SHARED_ARRAY<CONT> CONT::vc;
+mutex CONT::Lock;
+unordered_multimap<size_t, int> CONT::Interned;
+vector<int> CONT::FreeSlots;
+int CONT::Live = 0;
+
+size_t CONT::Key(int GroupID, PHYS_PROP *Prop, const Cost &Bound) {
+  size_t Hash = std::hash<double>()(Bound.GetValue());
+  Hash = Hash * 31 + GroupID;
+  return Hash * 31 + Prop->GetId();
+}
+
+int CONT::Add(CONT *Context) {
+  int ContID;
+  if (FreeSlots.empty())
+    ContID = vc.push_back(Context);
+  else {
+    ContID = FreeSlots.back();
+    FreeSlots.pop_back();
+    vc.set(ContID, Context);
+  }
+  OptStat->Contexts++;
+  if (++Live > OptStat->PeakContexts) OptStat->PeakContexts = Live;
+  return ContID;
+}
+
+int CONT::Intern(int GroupID, PHYS_PROP *Prop, const Cost &Bound) {
+  // the constructor may trim Prop to its best key, so compare what it keeps
+  CONT *Context = new CONT(Prop, Bound, false);
+  size_t Hash = Key(GroupID, Prop, Bound);
+
+  lock_guard<mutex> guard(Lock);
+  auto Range = Interned.equal_range(Hash);
+  for (auto Entry = Range.first; Entry != Range.second; Entry++) {
+    CONT *Other = vc[Entry->second];
+    if (Other->GroupID != GroupID || Other->Requested.GetValue() != Bound.GetValue() ||
+        Other->ReqdPhys->GetId() != Prop->GetId())
+      continue;
+
+    // A context whose last task has let go of it is about to be deleted
+    int Held = Other->Users;
+    while (Held > 0 && !Other->Users.compare_exchange_weak(Held, Held + 1))
+      ;
+    if (Held > 0) {
+      delete Context;
+      OptStat->SharedContexts++;
+      return (Entry->second);
+    }
+  }
+
+  Context->GroupID = GroupID;
+  Context->Requested = Bound;
+  Context->Users = 1;
+  int ContID = Add(Context);
+  Interned.emplace(Hash, ContID);
+  return (ContID);
+}
 
-void Cost::FinalCost(Cost *LocalCost, Cost **TotalInputCost, int Size) {
-  *this = *LocalCost;
+int CONT::Hold(CONT *Context) {
+  lock_guard<mutex> guard(Lock);
+  Context->Users = 1;
+  return (Add(Context));
+}
+
+void CONT::Release(int ContID) {
+  CONT *Context = vc[ContID];
+  if (!Context || --Context->Users > 0) return;
+
+  lock_guard<mutex> guard(Lock);
+  if (Context->GroupID >= 0) {
+    auto Range = Interned.equal_range(Key(Context->GroupID, Context->ReqdPhys, Context->Requested));
+    for (auto Entry = Range.first; Entry != Range.second; Entry++)
+      if (Entry->second == ContID) {
+        Interned.erase(Entry);
+        break;
+      }
+  }
+  vc.set(ContID, nullptr);
+  FreeSlots.push_back(ContID);
+  Live--;
+  delete Context;
+}
+
+void CONT::Clear() {
+  lock_guard<mutex> guard(Lock);
+  for (int i = 0; i < vc.size(); i++) delete vc[i];
+  vc.clear();
+  Interned.clear();
+  FreeSlots.clear();
+  Live = 0;
+}
+
+//=============  ARENA Methods  ===================
+
+ARENA::ARENA() : Cur(-1), Top(nullptr), End(nullptr), Used(0) {
+  for (int i = 0; i < FREE_LISTS; i++) FreeList[i] = nullptr;
+}
+
+ARENA::~ARENA() {
+  reset();
+  for (auto &&chunk : Chunks) ::operator delete(chunk);
+}
+
+void *ARENA::alloc(size_t size) {
+  size = (size + ALIGN - 1) & ~(size_t)(ALIGN - 1);
+  int List = size / ALIGN - 1;
+  if (List < FREE_LISTS && FreeList[List]) {
+    void *p = FreeList[List];
+    FreeList[List] = *(void **)p;
+    return p;
+  }
 
-  for (int i = Size; --i >= 0;) {
-    assert(TotalInputCost[i]);
-    *this += *(TotalInputCost[i]);
+  Used += size;
+  if (size > CHUNK_SIZE / 4) {
+    Big.push_back((char *)::operator new(size));
+    return Big.back();
   }
+
+  if ((ptrdiff_t)size > End - Top) {
+    if (++Cur == Chunks.size()) Chunks.push_back((char *)::operator new(CHUNK_SIZE));
+    Top = Chunks[Cur];
+    End = Top + CHUNK_SIZE;
+  }
+  void *p = Top;
+  Top += size;
+  return p;
+}
+
+void ARENA::free(void *p, size_t size) {
+  size = (size + ALIGN - 1) & ~(size_t)(ALIGN - 1);
+  int List = size / ALIGN - 1;
+  if (List >= FREE_LISTS) return;  // big objects stay until reset
+  *(void **)p = FreeList[List];
+  FreeList[List] = p;
+}
+
+bool ARENA::owns(void *p) {
+  for (int i = 0; i <= Cur; i++)
+    if (p >= Chunks[i] && p < Chunks[i] + CHUNK_SIZE) return true;
+  for (auto &&big : Big)
+    if (p == big) return true;
+  return false;
+}
+
+void ARENA::reset() {
+  for (auto &&big : Big) ::operator delete(big);
+  Big.clear();
+  for (int i = 0; i < FREE_LISTS; i++) FreeList[i] = nullptr;
+  Cur = -1;
+  Top = End = nullptr;
+  Used = 0;
+}
+
+//=============  Cost Methods  ===================
+
+void Cost::FinalCost(const Cost &LocalCost, const Cost *TotalInputCost, int Size) {
+  *this = LocalCost;
+
+  for (int i = Size; --i >= 0;) *this += TotalInputCost[i];
   return;
 }
 
-string Cost::Dump() { return to_string(Value); }
\ No newline at end of file
+// COVE and the traces show an infinite cost as -1
+string Cost::Dump() const { return is_infinite() ? "-1" : to_string(Value); }
\ No newline at end of file
@@ -1,25 +1,9 @@
 #include "../header/tasks.h"
 
+#include "../header/joinenum.h"
 #include "../header/physop.h"
 #include "../header/stdafx.h"
 
-/* Function to compare the promise of rule applications */
-int compare_moves(void const *x, void const *y) {
-  // Cast arguments back to pointers to MOVEs
-  MOVE *a = (MOVE *)x;
-  MOVE *b = (MOVE *)y;
-
-  int result = 0;
-  if (a->promise > b->promise)
-    result = -1;
-  else if (a->promise < b->promise)
-    result = 1;
-  else
-    result = 0;
-
-  return result;
-}
-
 /* Function to compare the cost of mexprs */
 int compare_afters(void const *x, void const *y) {
   // Cast arguments back to pointers to AFTER
@@ -27,9 +11,9 @@ int compare_afters(void const *x, void const *y) {
   AFTERS *b = (AFTERS *)y;
 
   int result = 0;
-  if ((*a->cost) < (*b->cost))
+  if (a->cost < b->cost)
     result = -1;
-  else if ((*a->cost) > (*b->cost))
+  else if (a->cost > b->cost)
     result = 1;
   else
     result = 0;
@@ -37,6 +21,247 @@ int compare_afters(void const *x, void const *y) {
   return result;
 }
 
+/* ============  Task memory  ============ */
+
+#define TASK_CHUNK (64 * 1024)
+#define TASK_ALIGN 16
+#define TASK_SIZES 16  // tasks of up to TASK_SIZES * TASK_ALIGN bytes are recycled
+
+static mutex TaskChunkLock;
+static vector<char *> *TaskChunks = new vector<char *>;  // never freed, tasks may be freed on any thread
+static thread_local char *TaskTop = nullptr;
+static thread_local char *TaskEnd = nullptr;
+static thread_local void *FreeTasks[TASK_SIZES];
+
+void *OptimizerTask::operator new(size_t size) {
+  size = (size + TASK_ALIGN - 1) & ~(size_t)(TASK_ALIGN - 1);
+  int List = size / TASK_ALIGN - 1;
+  if (List >= TASK_SIZES) return ::operator new(size);
+  if (FreeTasks[List]) {
+    void *p = FreeTasks[List];
+    FreeTasks[List] = *(void **)p;
+    return p;
+  }
+
+  if ((ptrdiff_t)size > TaskEnd - TaskTop) {
+    TaskTop = (char *)::operator new(TASK_CHUNK);
+    TaskEnd = TaskTop + TASK_CHUNK;
+    lock_guard<mutex> guard(TaskChunkLock);
+    TaskChunks->push_back(TaskTop);
+  }
+  void *p = TaskTop;
+  TaskTop += size;
+  return p;
+}
+
+void OptimizerTask::operator delete(void *p, size_t size) {
+  size = (size + TASK_ALIGN - 1) & ~(size_t)(TASK_ALIGN - 1);
+  int List = size / TASK_ALIGN - 1;
+  if (List >= TASK_SIZES) {
+    ::operator delete(p);
+    return;
+  }
+  *(void **)p = FreeTasks[List];
+  FreeTasks[List] = p;
+}
+
+/* ============  TaskScheduler  ============ */
+
+static thread_local int CurrentWorker = 0;                 // index of the worker running on this thread
+static thread_local OptimizerTask *CurrentTask = nullptr;  // the task this worker is performing
+
+int TaskScheduler::worker() { return CurrentWorker; }
+
+TaskScheduler::~TaskScheduler() {
+  for (auto &&worker : Workers) {
+    for (auto &&task : worker->Tasks) delete task;
+    delete worker;
+  }
+}
+
+void TaskScheduler::run(OptimizerTask *task, int Threads) {
+  assert(Threads >= 1 && Live == 0);
+  for (auto &&worker : Workers) delete worker;
+  Workers.clear();
+  for (int i = 0; i < Threads; i++) Workers.push_back(new TaskDeque);
+
+  Live = 1;
+  CurrentWorker = 0;
+  enqueue(task);
+
+  vector<thread> Helpers;
+  for (int i = 1; i < Threads; i++) Helpers.emplace_back(&TaskScheduler::work, this, i);
+  work(0);
+  for (auto &&helper : Helpers) helper.join();
+}
+
+void TaskScheduler::work(int WorkerId) {
+  CurrentWorker = WorkerId;
+  while (Live > 0 || Ssp->MergesQueued()) {
+    // tasks hold pointers into the groups, merge them only while none is performing
+    if (Ssp->MergesQueued()) {
+      stop();
+      continue;
+    }
+
+    OptimizerTask *task = next(WorkerId);
+    if (task)
+      execute(task);
+    else
+      this_thread::yield();  // every task is running or waiting on another worker
+  }
+}
+
+// wait until every worker is between tasks, then merge the queued groups
+void TaskScheduler::stop() {
+  unique_lock<mutex> lock(StopLock);
+  int Round = StopRound;
+  if (++Stopped < Workers.size()) {
+    StopCond.wait(lock, [&] { return StopRound != Round; });
+    return;
+  }
+
+  Ssp->MergeQueued();
+  Stopped = 0;
+  StopRound++;
+  StopCond.notify_all();
+}
+
+// pop the newest task of this worker, or steal the oldest task of another one
+OptimizerTask *TaskScheduler::next(int WorkerId) {
+  OptimizerTask *task = nullptr;
+  int Count = Workers.size();
+  for (int i = 0; i < Count && !task; i++) {
+    TaskDeque *worker = Workers[(WorkerId + i) % Count];
+    lock_guard<mutex> guard(worker->Lock);
+    if (worker->Tasks.empty()) continue;
+    if (i == 0) {
+      task = worker->Tasks.back();
+      worker->Tasks.pop_back();
+    } else {
+      task = worker->Tasks.front();
+      worker->Tasks.pop_front();
+    }
+  }
+  return task;
+}
+
+void TaskScheduler::execute(OptimizerTask *task) {
+  int ThisTaskNo = ++TaskNo;
+  PTRACE("--------------------------Starting task " << ThisTaskNo << "-----------------------------");
+  COVE("PopTaskList  {" << task->Dump() << "}");
+
+  // hold the task open while it performs, so children finishing early do not complete it
+  task->Pending++;
+  task->Resume = false;
+  CurrentTask = task;
+  task->perform();
+  CurrentTask = nullptr;
+  release(task);
+
+  PTRACE("------------------ SearchSpace after task " << ThisTaskNo << ": ");
+  OUTPUT_DEBUG(Ssp->DumpChanged());
+
+  PTRACE("------------------ OPEN after task " << ThisTaskNo << ":");
+  OUTPUT_DEBUG(Dump());
+}
+
+void TaskScheduler::enqueue(OptimizerTask *task) {
+  // once the task is in the deque, another worker may steal and finish it
+  COVE("PushTaskList {" << task->Dump() << "}");
+
+  TaskDeque *worker = Workers[CurrentWorker];
+  lock_guard<mutex> guard(worker->Lock);
+  worker->Tasks.push_back(task);
+}
+
+// one of the things task was waiting for is done
+void TaskScheduler::release(OptimizerTask *task) {
+  while (task && --task->Pending == 0) {
+    if (task->Resume) {
+      enqueue(task);
+      return;
+    }
+
+    // task and its whole frame are done
+    task->finish();
+    OptimizerTask *Parent = task->Parent;
+    OptimizerTask *Successor = task->Successor;
+    delete task;
+    Live--;
+
+    if (Successor) release(Successor);
+    task = Parent;
+  }
+}
+
+void TaskScheduler::push(OptimizerTask *task) {
+  assert(CurrentTask);
+  task->Parent = CurrentTask;
+  CurrentTask->Pending++;
+  Live++;
+  enqueue(task);
+}
+
+void TaskScheduler::push(OptimizerTask *task, const vector<OptimizerTask *> &prereqs) {
+  if (prereqs.empty()) {
+    push(task);
+    return;
+  }
+
+  assert(CurrentTask);
+  task->Parent = CurrentTask;
+  CurrentTask->Pending++;
+  Live++;
+
+  // the task starts when the last prerequisite releases it
+  task->Pending = prereqs.size();
+  task->Resume = true;
+  for (auto &&prereq : prereqs) {
+    assert(!prereq->Successor);
+    prereq->Successor = task;
+  }
+}
+
+void TaskScheduler::suspend(OptimizerTask *task) {
+  assert(task == CurrentTask);
+  task->Resume = true;
+}
+
+// called under the lock of the group owning waiters
+void TaskScheduler::wait(OptimizerTask *task, vector<OptimizerTask *> &waiters) {
+  assert(task == CurrentTask);
+  task->Resume = true;
+  task->Pending++;
+  waiters.push_back(task);
+}
+
+// called after taking waiters from the group under its lock, but not holding it:
+// releasing a task may finish its parents, which lock their own groups
+void TaskScheduler::wake(vector<OptimizerTask *> &waiters) {
+  vector<OptimizerTask *> Woken;
+  Woken.swap(waiters);
+  for (auto &&task : Woken) release(task);
+}
+
+string TaskScheduler::Dump() {
+  TaskDeque *worker = Workers[CurrentWorker];
+  lock_guard<mutex> guard(worker->Lock);
+
+  string os;
+  if (worker->Tasks.empty())
+    os = "Task Stack is empty!!";
+  else {
+    int count1 = worker->Tasks.size() - 5;
+    int count = 0;
+    for (auto &&task : worker->Tasks) {
+      if (count >= count1) os += "    task: " + to_string(count) + "   " + task->Dump() + "\n";
+      count++;
+    }
+  }
+  return os;
+}
+
 /*
 OptimizeGroupTask::perform
 {
@@ -81,9 +306,10 @@ OptimizeGroupTask::perform
     對於物理表達式。使用optinputtask優化
 */
 void OptimizeGroupTask::perform() {
+  // the group may have been merged into another one since this task was pushed
+  group_ = Ssp->GetGroup(group_->GetGroupID());
   auto GrpID = group_->GetGroupID();
-  PTRACE("OptimizeGroupTask: " << GrpID << " is performing "
-                               << "Last flag is " << Last);
+  PTRACE("OptimizeGroupTask: " << GrpID << " is performing");
 
   PTRACE("Context ID: " << ContextID << " , " << CONT::vc[ContextID]->Dump());
 
@@ -91,8 +317,8 @@ void OptimizeGroupTask::perform() {
 
   if (FirstLogMExpr->GetOp()->is_const()) {
     PTRACE("Group " << GrpID << " is const group");
-    MExression *WPlan = new MExression(*FirstLogMExpr);
-    group_->NewWinner(new PHYS_PROP(any), WPlan, new Cost(0), true);
+    PHYS_PROP AnyProp(any);
+    group_->NewWinner(&AnyProp, FirstLogMExpr, Cost(0), true);
     return;
   }
 
@@ -100,14 +326,30 @@ void OptimizeGroupTask::perform() {
 
   CONT *LocalCont = CONT::vc[ContextID];
   PHYS_PROP *LocalReqdProp = LocalCont->GetPhysProp();  // What prop is required
-  Cost *LocalCost = LocalCont->GetUpperBd();
+  Cost LocalCost = LocalCont->GetUpperBd();
+
+  // Decide under the group's lock, so that two workers never begin the same search
+  lock_guard<recursive_mutex> guard(group_->GetLock());
+
+  // Another worker is searching this group for the same property, or exploring it.
+  // Wait until it is done, then look at the winner's circle again.
+  WINNER *Winner = group_->GetWinner(LocalReqdProp);
+  if (Winner && !Winner->GetDone()) {
+    PTRACE("Group " << GrpID << " is being searched for " << LocalReqdProp->Dump() << ", wait for it");
+    PTasks.wait(this, group_->GetWaiters(LocalReqdProp));
+    return;
+  }
+  if (group_->is_exploring() && !group_->is_explored()) {
+    PTRACE("Group " << GrpID << " is being explored, wait for it");
+    PTasks.wait(this, group_->GetExploreWaiters());
+    return;
+  }
 
   SCReturn = group_->search_circle(LocalCont, moreSearch);
 
   // If case (2) or (1), terminate this task
   if (!moreSearch) {
     PTRACE("Winner's circle is prepared so terminate this task");
-    delete this;
     return;
   }
 
@@ -116,17 +358,23 @@ void OptimizeGroupTask::perform() {
     assert(moreSearch && !SCReturn);  // assert (this is case 3)
     // if (property is ANY)
     if (LocalReqdProp->GetOrder() == any) {
-      PTRACE("add winner with null plan, push OptimizeExprTask on 1st logical expression");
-      group_->NewWinner(LocalReqdProp, nullptr, new Cost(*LocalCost), false);
-      PTasks.push(new OptimizeExprTask(FirstLogMExpr, false, ContextID, TaskNo, true));
+      PTRACE("add winner with null plan, push OptimizeExprTask on all logical expressions");
+      group_->NewWinner(LocalReqdProp, nullptr, LocalCost, false);
+      Searching = true;
+      // An explored group already holds its logical expressions, and firing
+      // rules on the first one would only find duplicates of them
+      vector<MExression *> LogMExprs;
+      for (MExression *LogMExpr = FirstLogMExpr; LogMExpr; LogMExpr = LogMExpr->GetNextMExpr())
+        LogMExprs.push_back(LogMExpr);
+      for (int count = LogMExprs.size(); --count >= 0;)
+        PTasks.push(new OptimizeExprTask(LogMExprs[count], false, ContextID, TaskNo));
     } else {
-      PTRACE("Push OptimizeGroupTask with current context, another with ANY context");
+      PTRACE("Push OptimizeGroupTask with ANY context, then perform this task again");
       assert(LocalReqdProp->GetOrder() == sorted);  // temporary
-      PTasks.push(new OptimizeGroupTask(group_, ContextID, TaskNo, true));
-      Cost *NewCost = new Cost(*(LocalCont->GetUpperBd()));
-      CONT *NewContext = new CONT(new PHYS_PROP(any), NewCost, false);
-      CONT::vc.push_back(NewContext);
-      PTasks.push(new OptimizeGroupTask(group_, CONT::vc.size() - 1, TaskNo, true));
+      PTasks.suspend(this);
+      int ContID = CONT::Intern(group_->GetGroupID(), new PHYS_PROP(any), LocalCont->GetUpperBd());
+      PTasks.push(new OptimizeGroupTask(group_, ContID, TaskNo));
+      CONT::Release(ContID);
     }
   } else  // Group is optimized
   {
@@ -138,38 +386,38 @@ void OptimizeGroupTask::perform() {
     if (LocalReqdProp->GetOrder() == any) {
       PTRACE("push OptimizeInputTask on all physical mexprs");
       assert(moreSearch && SCReturn);
+      // search again, with the larger upper bound of this context
+      group_->SetWinnerDone(LocalReqdProp, false);
+      Searching = true;
       for (MExression *PhysMExpr = group_->GetFirstPhysMExpr(); PhysMExpr; PhysMExpr = PhysMExpr->GetNextMExpr()) {
         PhysMExprs.push_back(PhysMExpr);
         count++;
       }
-      // push the last PhysMExpr
-      if (--count >= 0) {
-        PTRACE("pushing OptimizeInputTask " << PhysMExprs[count]->Dump());
-        PTasks.push(new OptimizeInputTask(PhysMExprs[count], ContextID, TaskNo, true));
-      }
-      // push other PhysMExpr
       while (--count >= 0) {
         PTRACE("pushing OptimizeInputTask " << PhysMExprs[count]->Dump());
-        PTasks.push(new OptimizeInputTask(PhysMExprs[count], ContextID, TaskNo, false));
+        PTasks.push(new OptimizeInputTask(PhysMExprs[count], ContextID, TaskNo));
       }
     } else  // property is not ANY)
     {
       assert(LocalReqdProp->GetOrder() == sorted);  // temporary
-      // Push OptimizeInputTask on all physical mexprs with current context, last one is last task
+      // add a winner to the circle, with null plan.
+      //(i.e., initialize the winner's circle for this property.)
+      PTRACE("Init winner's circle for this property");
+      if (moreSearch && !SCReturn)
+        group_->NewWinner(LocalReqdProp, nullptr, LocalCost, false);
+      else
+        group_->SetWinnerDone(LocalReqdProp, false);
+      Searching = true;
+
+      // Push OptimizeInputTask on all physical mexprs with current context
       PTRACE("Push OptimizeInputTask on all physical mexprs");
       for (MExression *PhysMExpr = group_->GetFirstPhysMExpr(); PhysMExpr; PhysMExpr = PhysMExpr->GetNextMExpr()) {
         PhysMExprs.push_back(PhysMExpr);
         count++;
       }
-      // push the last PhysMExpr
-      if (--count >= 0) {
-        PTRACE("pushing OptimizeInputTask " << PhysMExprs[count]->Dump());
-        PTasks.push(new OptimizeInputTask(PhysMExprs[count], ContextID, TaskNo, true));
-      }
-      // push other PhysMExpr
       while (--count >= 0) {
         PTRACE("pushing OptimizeInputTask " << PhysMExprs[count]->Dump());
-        PTasks.push(new OptimizeInputTask(PhysMExprs[count], ContextID, TaskNo, false));
+        PTasks.push(new OptimizeInputTask(PhysMExprs[count], ContextID, TaskNo));
       }
 
       // If case (3) [i.e. appropriate enforcer is not in group], Push ApplyRuleTask on
@@ -178,82 +426,115 @@ void OptimizeGroupTask::perform() {
         PTRACE("Push ApplyRuleTask on enforcer rule");
         if (LocalReqdProp->GetOrder() == sorted) {
           Rule *Rule = (*ruleSet)[R_SORT_RULE];
-          PTasks.push(new ApplyRuleTask(Rule, FirstLogMExpr, false, ContextID, TaskNo, false));
+          PTasks.push(new ApplyRuleTask(Rule, FirstLogMExpr, false, ContextID, TaskNo));
         } else {
           assert(false);
         }
       }
-      // add a winner to the circle, with null plan.
-      //(i.e., initialize the winner's circle for this property.)
-      PTRACE("Init winner's circle for this property");
-      if (moreSearch && !SCReturn) group_->NewWinner(LocalReqdProp, nullptr, new Cost(*LocalCost), false);
     }
   }
-  delete this;
-
 }  // OptimizeGroupTask::perform
 
+void OptimizeGroupTask::finish() {
+  if (!Searching) return;
+
+  // the search this task began is complete
+  group_ = Ssp->GetGroup(group_->GetGroupID());
+  PHYS_PROP *ReqdProp = CONT::vc[ContextID]->GetPhysProp();
+  vector<OptimizerTask *> Waiters;
+  {
+    lock_guard<recursive_mutex> guard(group_->GetLock());
+    group_->SetWinnerDone(ReqdProp, true);
+    group_->set_optimized(true);
+    Waiters.swap(group_->GetWaiters(ReqdProp));
+  }
+
+  WINNER *Winner = group_->GetWinner(ReqdProp);
+  MExression *WPlan = Winner->GetMPlan();
+  PTRACE("Group " << group_->GetGroupID() << " winner done: " << Winner->GetPhysProp()->Dump() << ", "
+                  << (WPlan ? WPlan->Dump() : " nullptr ") << ", " << Winner->GetCost().Dump());
+
+  PTasks.wake(Waiters);
+}
+
 string OptimizeGroupTask::Dump() {
   string os;
-  os = "OptimizeGroupTask group: " + to_string(group_->GetGroupID()) + ", parent task: " + to_string(ParentTaskNo) +
-       ", Last: " + to_string(Last);
+  os = "OptimizeGroupTask group: " + to_string(group_->GetGroupID()) + ", parent task: " + to_string(ParentTaskNo);
   os += ", " + CONT::vc[ContextID]->Dump();
   return os;
 }
 
 void ExploreGroupTask::perform() {
+  // the group may have been merged into another one since this task was pushed
+  group_ = Ssp->GetGroup(group_->GetGroupID());
   auto GrpID = group_->GetGroupID();
   PTRACE("ExploreGroupTask " << GrpID << " performing");
   PTRACE("Context ID: " << ContextID << " , " << CONT::vc[ContextID]->Dump());
 
-  if (group_->is_optimized() || group_->is_explored()) {
-    delete this;
+  lock_guard<recursive_mutex> guard(group_->GetLock());
+
+  if (group_->is_optimized() || group_->is_explored()) return;
+
+  // Another worker is exploring the group, or optimizing it, which generates
+  // all its logical expressions too.  Wait until it is done.
+  if (group_->is_exploring()) {
+    PTRACE("Group " << GrpID << " is being explored, wait for it");
+    PTasks.wait(this, group_->GetExploreWaiters());
+    return;
+  }
+  PHYS_PROP AnyProp(any);
+  WINNER *Winner = group_->GetWinner(&AnyProp);
+  if (Winner && !Winner->GetDone()) {
+    PTRACE("Group " << GrpID << " is being optimized, wait for it");
+    PTasks.wait(this, group_->GetWaiters(&AnyProp));
     return;
   }
 
-  if (group_->is_exploring())
-    assert(false);
-  else {
-    // the group will be explored, let other tasks don't do it again
-    group_->set_exploring(true);
+  // the group will be explored, let other tasks don't do it again
+  group_->set_exploring(true);
+  Exploring = true;
 
-    // mark the group not explored since we will begin exploration
-    group_->set_explored(false);
+  // mark the group not explored since we will begin exploration
+  group_->set_explored(false);
 
-    MExression *LogMExpr = group_->GetFirstLogMExpr();
+  MExression *LogMExpr = group_->GetFirstLogMExpr();
 
-    // only need to E_EXPR the first log expr,
-    // because it will generate all logical exprs by applying appropriate rules
-    // it won't generate dups because rule bit vector
-    PTRACE("pushing OptimizeExprTask exploring " << LogMExpr->Dump());
-    // this logical mexpr will be the last optimized one, mark it as the last task for this group
-    PTasks.push(new OptimizeExprTask(LogMExpr, true, ContextID, TaskNo, true));
-  }
+  // only need to E_EXPR the first log expr,
+  // because it will generate all logical exprs by applying appropriate rules
+  // it won't generate dups because rule bit vector
+  PTRACE("pushing OptimizeExprTask exploring " << LogMExpr->Dump());
+  PTasks.push(new OptimizeExprTask(LogMExpr, true, ContextID, TaskNo));
+}
 
-  delete this;
+void ExploreGroupTask::finish() {
+  if (!Exploring) return;
+
+  group_ = Ssp->GetGroup(group_->GetGroupID());
+  vector<OptimizerTask *> Waiters;
+  {
+    lock_guard<recursive_mutex> guard(group_->GetLock());
+    group_->set_explored(true);
+    Waiters.swap(group_->GetExploreWaiters());
+  }
+  PTasks.wake(Waiters);
 }
 
 string ExploreGroupTask::Dump() {
   string os;
-  os = "ExploreGroupTask  group: " + to_string(group_->GetGroupID()) + ", parent task: " + to_string(ParentTaskNo) +
-       ", Last: " + to_string(Last);
+  os = "ExploreGroupTask  group: " + to_string(group_->GetGroupID()) + ", parent task: " + to_string(ParentTaskNo);
   os += ", " + CONT::vc[ContextID]->Dump();
   return os;
 }
 
 // ************  OptimizeExprTask ******************
 
-OptimizeExprTask::OptimizeExprTask(MExression *mexpr, bool explore, int ContextID, int parent_task_no, bool last)
-    : OptimizerTask(ContextID, parent_task_no),
-      MExpr(mexpr),
-      explore(explore),
-      Last(last){};  // OptimizeExprTask::OptimizeExprTask
+OptimizeExprTask::OptimizeExprTask(MExression *mexpr, bool explore, int ContextID, int parent_task_no)
+    : OptimizerTask(ContextID, parent_task_no), MExpr(mexpr), explore(explore){};  // OptimizeExprTask::OptimizeExprTask
 
 void OptimizeExprTask::perform() {
   PTRACE("OptimizeExprTask performing, " << (explore ? "exploring" : "optimizing") << " mexpr: " << MExpr->Dump());
 
   PTRACE("Context ID: " << ContextID << " , " << CONT::vc[ContextID]->Dump());
-  PTRACE("Last flag is " << Last);
 
   if (explore) assert(MExpr->GetOp()->is_logical());  // explore is only for logical expression
 
@@ -261,87 +542,93 @@ void OptimizeExprTask::perform() {
     PTRACE("expression is an item_op");
     // push the O_INPUT for this item_expr
     PTRACE("pushing OptimizeInputTask " << MExpr->Dump());
-    PTasks.push(new OptimizeInputTask(MExpr, ContextID, TaskNo, true));
-    delete this;
+    PTasks.push(new OptimizeInputTask(MExpr, ContextID, TaskNo));
     return;
   }
 
-  // identify valid and promising rules
-  MOVE *Move = new MOVE[ruleSet->RuleCount];  // to collect valid, promising moves
-  int moves = 0;                              // # of moves already collected
-  for (int RuleNo = 0; RuleNo < ruleSet->RuleCount; RuleNo++) {
-    Rule *Rule = (*ruleSet)[RuleNo];
-
-    if (Rule == nullptr) continue;  // some rules may be turned off
-
-    if (explore && Rule->GetSubstitute()->GetOp()->is_physical()) {
-      PTRACE("Rejected rule  " << Rule->get_index());
-      continue;  // only fire transformation rule when exploring
-    }
+  // past the deadline only the implementation rules are fired
+  bool Anytime = Ssp->PastDeadline();
+  if (explore && Anytime) {
+    PTRACE("deadline passed, stop exploring");
+    return;
+  }
 
-    int Promise = Rule->promise(MExpr->GetOp(), ContextID);
-    // insert a valid and promising move into the array
-    if (Rule->top_match(MExpr->GetOp()) && Promise > 0) {
-      Move[moves].promise = Promise;
-      Move[moves++].rule = Rule;
-      TopMatch[RuleNo]++;
+  // a JoinEnumerator has copied in the join orders of this group, or the
+  // first pass for a seed plan keeps the orders the group starts with
+  bool Enumerated = ForGlobalEpsPruning || Ssp->GetGroup(MExpr->GetGrpID())->is_enumerated();
+
+  // identify valid and promising rules among those indexed under the operator
+  RULE_LIST &Candidates = ruleSet->Candidates(MExpr->GetOp());
+  MOVE Move[R_END];  // to collect valid, promising moves
+  int moves = 0;     // # of moves already collected
+  for (int List = 0; List < (explore ? 1 : 2); List++) {
+    // only fire transformation rules when exploring
+    for (auto &&Rule : (List == 0) ? Candidates.Explore : Candidates.Implement) {
+      int RuleNo = Rule->get_index();
+      if (!MExpr->can_fire(RuleNo)) continue;  // fired already, or masked by the rule which made MExpr
+      if (Enumerated && JoinEnumerator::Reorders(RuleNo)) continue;
+
+      int Promise = Rule->promise(MExpr->GetOp(), ContextID);
+      // insert a valid and promising move into the array
+      if (Promise > 0) {
+        if (Anytime && List == 0) {
+          OptStat->SkippedRule++;
+          continue;
+        }
+        // keep the moves ordered by promise, and by rule number for equal promises
+        int i = moves++;
+        for (; i > 0 && Move[i - 1].promise < Promise; i--) Move[i] = Move[i - 1];
+        Move[i].promise = Promise;
+        Move[i].rule = Rule;
+        TopMatch[RuleNo]++;
+      }
     }
   }
 
   PTRACE(moves << " promising moves");
 
-  // order the valid and promising moves by their promise
-  qsort((char *)Move, moves, sizeof(MOVE), compare_moves);
   // optimize the rest rules in order of promise
   while (--moves >= 0) {
-    bool Flag = false;
-    if (Last)
-    // this's the last task in the group,pass it to the new task
-    {
-      Last = false;  // turn off this, since it's no longer the last task
-      Flag = true;
-    }
-
     // push future tasks in reverse order (due to LIFO stack)
     Rule *Rule = Move[moves].rule;
     PTRACE("pushing rule " << Rule->GetName());
 
-    // apply the rule
-    PTasks.push(new ApplyRuleTask(Rule, MExpr, explore, ContextID, TaskNo, Flag));
-
     // for enforcer and expansion rules, don't explore patterns
     Expression *original = Rule->GetOriginal();
-    if (original->GetOp()->is_leaf()) continue;
-
-    // earlier tasks: explore all inputs to match the original pattern
-    for (int input_no = original->GetArity(); --input_no >= 0;) {
-      // only explore the input with arity > 0
-      if (original->GetInput(input_no)->GetArity()) {
-        // If not yet explored, schedule a task with new context
-        int grp_no = (MExpr->GetInput(input_no));
-        if (!Ssp->GetGroup(grp_no)->is_exploring()) {
-          // ExploreGroupTask can not be the last task for the group
-          PTasks.push(new ExploreGroupTask(Ssp->GetGroup(grp_no), ContextID, TaskNo, false));
+    vector<OptimizerTask *> Explores;
+    if (!original->GetOp()->is_leaf()) {
+      // earlier tasks: explore all inputs to match the original pattern
+      for (int input_no = original->GetArity(); --input_no >= 0;) {
+        // only explore the input with arity > 0
+        if (original->GetInput(input_no)->GetArity()) {
+          // If not yet explored, schedule a task with new context
+          int grp_no = (MExpr->GetInput(input_no));
+          if (!Ssp->GetGroup(grp_no)->is_explored())
+            Explores.push_back(new ExploreGroupTask(Ssp->GetGroup(grp_no), ContextID, TaskNo));
         }
       }
-    }  // earlier tasks: explore all inputs to match the original pattern
+    }
 
+    // apply the rule once the inputs are explored
+    PTasks.push(new ApplyRuleTask(Rule, MExpr, explore, ContextID, TaskNo), Explores);
+    for (auto &&Explore : Explores) PTasks.push(Explore);
   }  // optimize in order of promise
-
-  delete[] Move;
-  delete this;
 }  // OptimizeExprTask::perform
 
 string OptimizeExprTask::Dump() {
   string os;
   os = "OptimizeExprTask  group: " + MExpr->Dump() + ", parent task: " + to_string(ParentTaskNo) +
-       ", Last: " + to_string(Last) + ", explore: " + to_string(explore);
+       ", explore: " + to_string(explore);
   os += ", " + CONT::vc[ContextID]->Dump();
   return os;
 }
 
-OptimizeInputTask::OptimizeInputTask(MExression *MExpr, int ContextID, int ParentTaskNo, bool last, int ContNo)
-    : MExpr(MExpr), OptimizerTask(ContextID, ParentTaskNo), InputNo(-1), Last(last), PrevInputNo(-1), ContNo(ContNo) {
+OptimizeInputTask::OptimizeInputTask(MExression *MExpr, int ContextID, int ParentTaskNo, int ContNo)
+    : MExpr(MExpr),
+      OptimizerTask(ContextID, ParentTaskNo),
+      InputNo(-1),
+      PrevInputNo(-1),
+      ContNo(ContNo) {
   assert(MExpr->GetOp()->is_physical() || MExpr->GetOp()->is_item());
   // We can only calculate cost for physical operators
 
@@ -350,17 +637,17 @@ OptimizeInputTask::OptimizeInputTask(MExression *MExpr, int ContextID, int Paren
   arity = Op->GetArity();                               // cache arity of mexpr
 
   // create the arrays of input costs and logical properties
-  if (arity) {
-    InputCost = new Cost *[arity];
+  if (arity <= INLINE_ARITY) {
+    InputCost = InlineCost;
+    InputLogProp = InlineLogProp;
+  } else {
+    InputCost = new Cost[arity];
     InputLogProp = new LOG_PROP *[arity];
   }
 };
 
 OptimizeInputTask::~OptimizeInputTask() {
-  // localcost was new by find_local_cost, so need to delete it
-  delete LocalCost;
-
-  if (arity) {
+  if (arity > INLINE_ARITY) {
     delete[] InputCost;
     delete[] InputLogProp;
   }
@@ -472,7 +759,6 @@ void OptimizeInputTask::perform() {
   PTRACE("O_INPUT performing Input " << InputNo << ", expr: " << MExpr->Dump());
 
   PTRACE("Context ID: " << ContextID << " , " << CONT::vc[ContextID]->Dump());
-  PTRACE("Last flag is " << Last);
 
   // Cache local properties of G and the expression being optimized
 
@@ -485,7 +771,7 @@ void OptimizeInputTask::perform() {
   Group *LocalGroup = Ssp->GetGroup(MExpr->GetGrpID());  // Group of the MExpr
 
   PHYS_PROP *LocalReqdProp = CONT::vc[ContextID]->GetPhysProp();  // What prop is required
-  Cost *LocalUB = CONT::vc[ContextID]->GetUpperBd();
+  Cost LocalUB = CONT::vc[ContextID]->GetUpperBd();
 
   // Declare locals
   int IGNo;  // Input Group Number
@@ -495,9 +781,6 @@ void OptimizeInputTask::perform() {
                   //	Cost * CostSoFar = new Cost(0);
   Cost CostSoFar(0);
 
-  WINNER *LocalWinner = LocalGroup->GetWinner(LocalReqdProp);  // Winner in G
-  Cost Zero(0);
-
   // On the first (and no other) execution, code must initialize some OptimizeInputTask members.
   // The only nontrivial member is InputCost.
   if (InputNo == -1) {
@@ -516,7 +799,7 @@ void OptimizeInputTask::perform() {
       if (!Pruning) {
         if (!input) PTRACE("Not pruning so all InputCost elements are set to zero");
         assert(!CuCardPruning);
-        InputCost[input] = &Zero;
+        InputCost[input] = Cost(0);
         continue;
       }
 
@@ -547,34 +830,30 @@ void OptimizeInputTask::perform() {
 
       // call search_circle on IG with that property, infinite cost.
       bool moreSearch, SCReturn;
-      Cost *INFCost = new Cost(-1);
-
-      CONT *IGContext = new CONT(ReqProp, INFCost, false);
-      SCReturn = IG->search_circle(IGContext, moreSearch);
+      WINNER *IGWinner;  // the winner search_circle saw; another search may replace it
+      CONT IGContext(ReqProp, Cost::Infinite(), false);
+      SCReturn = IG->search_circle(&IGContext, moreSearch, IGWinner);
       PTRACE("search_circle(): more search " << (moreSearch ? "" : "not") << " needed, return value is "
                                              << (SCReturn ? "true" : "false"));
 
       // If case (1), impossible, then terminate this task
       if (!moreSearch && !SCReturn) {
         PTRACE("Impossible search: Bad input " << input);
-        delete IGContext;
         goto TerminateThisTask;
       }
       // If search_circle returns a non-null Winner from InputGroup, case (2)
       // InputCost[InputGroup] = cost of that winner
       else if (!moreSearch && SCReturn) {
-        InputCost[input] = IG->GetWinner(ReqProp)->GetCost();
-        assert(IG->GetWinner(ReqProp)->GetDone());
+        InputCost[input] = IGWinner->GetCost();
+        assert(IGWinner->GetDone());
       }
       // else if (!CuCardPruning) //Group Pruning case (since Starburst not relevant here)
       // InputCost[IG] = 0
       else if (!CuCardPruning)
-        InputCost[input] = &Zero;
+        InputCost[input] = Cost(0);
       // remainder applies only in CuCardPruning case
       else
         InputCost[input] = IG->GetLowerBd();
-
-      delete IGContext;
     }  // initialize some OptimizeInputTask members
 
     InputNo++;  // Ensure that previous code will not be executed again; begin with Input 0
@@ -582,8 +861,8 @@ void OptimizeInputTask::perform() {
 
   // If Global Pruning and cost so far is greater than upper bound for this context, then terminate
   CostSoFar.FinalCost(LocalCost, InputCost, arity);
-  if (Pruning && CostSoFar >= *LocalUB) {
-    PTRACE("Expr LowerBd " << CostSoFar.Dump() << ", exceed Cond UpperBd " << LocalUB->Dump() << ",Pruning applied!");
+  if (Pruning && CostSoFar >= LocalUB) {
+    PTRACE("Expr LowerBd " << CostSoFar.Dump() << ", exceed Cond UpperBd " << LocalUB.Dump() << ",Pruning applied!");
     goto TerminateThisTask;
   }
 
@@ -616,23 +895,21 @@ void OptimizeInputTask::perform() {
       ReqProp = new PHYS_PROP(any);
 
     bool moreSearch, SCReturn;
-    Cost *INFCost = new Cost(-1);
+    WINNER *Winner;  // the winner search_circle saw; another search may replace it
 
     // call search_circle on IG with that property, infinite cost.
-    CONT *IGContext = new CONT(ReqProp, INFCost, false);
-    SCReturn = IG->search_circle(IGContext, moreSearch);
+    CONT IGContext(ReqProp, Cost::Infinite(), false);
+    SCReturn = IG->search_circle(&IGContext, moreSearch, Winner);
 
     // If case (1), impossible so terminate
     if (!moreSearch && !SCReturn) {
       PTRACE("Impossible search: Bad input " << input);
-      delete IGContext;
       goto TerminateThisTask;
     }
 
     // else if case (2)
     else if (!moreSearch && SCReturn) {  // There is a winner with nonzero plan, in current input
       PTRACE("Found Winner for Input : " << input);
-      WINNER *Winner = IG->GetWinner(ReqProp);
       assert(Winner->GetDone());
 
       // store its cost in InputCost[]
@@ -640,15 +917,13 @@ void OptimizeInputTask::perform() {
 
       CostSoFar.FinalCost(LocalCost, InputCost, arity);
       // if (Pruning && CostSoFar >= upper bound) terminate this task
-      if (Pruning && CostSoFar >= *LocalUB) {
-        PTRACE("Expr LowerBd " << CostSoFar.Dump() << ", exceed Cond UpperBd " << LocalUB->Dump()
+      if (Pruning && CostSoFar >= LocalUB) {
+        PTRACE("Expr LowerBd " << CostSoFar.Dump() << ", exceed Cond UpperBd " << LocalUB.Dump()
                                << ",Pruning applied!");
         PTRACE("This happened at group " << IGNo);
 
-        delete IGContext;
         goto TerminateThisTask;
       }
-      delete IGContext;
     }
 
     // Remaining cases are (3) and (4)
@@ -660,39 +935,33 @@ void OptimizeInputTask::perform() {
       PrevInputNo = input;
       InputNo = input;
 
-      // push this task
-      PTasks.push(this);
-      PTRACE("push myself, O_INPUT");
+      // perform this task again once the input group is optimized
+      PTasks.suspend(this);
+      PTRACE("suspend myself, O_INPUT");
 
       // Build a context for the input group task
       // First calculate the upper bound for search of input group.
       // Upper bounds are irrelevant unless we are pruning
-      Cost *InputBd = new Cost(*LocalUB);  // Start with upper bound of G's context
+      Cost InputBd = LocalUB;  // Start with upper bound of G's context
       if (Pruning) {
-        PTRACE("LocalCost is " << LocalCost->Dump());
+        PTRACE("LocalCost is " << LocalCost.Dump());
         CostSoFar.FinalCost(LocalCost, InputCost, arity);
-        *InputBd -= CostSoFar;          // Subtract CostSoFar
-        *InputBd += *InputCost[input];  // push_back IG's contribution to CostSoFar
+        InputBd -= CostSoFar;         // Subtract CostSoFar
+        InputBd += InputCost[input];  // push_back IG's contribution to CostSoFar
       }
 
-      PHYS_PROP *InputProp = new PHYS_PROP(*ReqProp);
-      // update the bound in multiwinner to InputBd
-      CONT *InputContext = new CONT(InputProp, InputBd, false);
-      CONT::vc.push_back(InputContext);
-      // Push OptimizeGroupTask
-      int ContID = CONT::vc.size() - 1;
+      // Push OptimizeGroupTask, in a context another search of IG may share
+      int ContID = CONT::Intern(IG->GetGroupID(), new PHYS_PROP(*ReqProp), InputBd);
       PTRACE("push OptimizeGroupTask " << IGNo << ", " << CONT::vc[ContID]->Dump());
 
-      PTasks.push(new OptimizeGroupTask(IG, ContID, TaskNo, true));
+      PTasks.push(new OptimizeGroupTask(IG, ContID, TaskNo));
+      CONT::Release(ContID);
 
-      // delete (void*) CostSoFar;
-      delete IGContext;
       return;
     } else  // We just returned from OptimizeGroupTask on IG
     {
       // impossible plan for this context
       PTRACE("impossible plan since no winner possible at input " << InputNo);
-      delete IGContext;
       goto TerminateThisTask;
     }
   }  // Calculate the cost of remaining inputs
@@ -713,9 +982,8 @@ void OptimizeInputTask::perform() {
   // All inputs have been been optimized, so compute cost of the expression being optimized.
 
   // If we are in the root group and no plan in it has been costed
-  if (!(MExpr->GetGrpID()) && !(LocalGroup->getfirstplan())) {
+  if (!(MExpr->GetGrpID()) && !(LocalGroup->setfirstplan(true)) && !ForGlobalEpsPruning) {
     OUTPUT("First Plan is costed at task " << TaskNo);
-    LocalGroup->setfirstplan(true);
   }
 
   CostSoFar.FinalCost(LocalCost, InputCost, arity);
@@ -725,7 +993,7 @@ void OptimizeInputTask::perform() {
   // last winner >= HaltGrpSize*EstiGrpSize or the improvement in last HaltWinSize
   // winners is <= HaltImpr. This only works for EQJOIN
   if (Halt) {
-    if (LocalGroup->GetFirstLogMExpr()->GetOp()->GetName() == ("EQJOIN")) {
+    if (LocalGroup->GetFirstLogMExpr()->GetOp()->GetOpcode() == OPCODE::EQJOIN) {
       double esti_grp_size = LocalGroup->GetEstiGrpSize();
       int plan_count = LocalGroup->GetCount();
       double halt_size = esti_grp_size * HaltGrpSize / 100;
@@ -738,74 +1006,52 @@ void OptimizeInputTask::perform() {
       if (plan_count >= halt_size) {
         PTRACE("Halting condition satisfied, got a final winner for this context");
 
-        if (!LocalWinner->GetMPlan() ||            /// If there is no non-null local winner
-            CostSoFar < *(LocalWinner->GetCost())  // and current expression is more expensive
-        ) {
-          // update the winner
-          Cost *WinCost = new Cost(CostSoFar);
-          LocalGroup->NewWinner(LocalReqdProp, MExpr, WinCost, true);
+        // update the winner, if there is no non-null local winner or it is more expensive
+        if (LocalGroup->ImproveWinner(LocalReqdProp, MExpr, CostSoFar))
           // update the upperbound of the current context
           CONT::vc[ContextID]->SetUpperBound(CostSoFar);
-          CONT::vc[ContextID]->done();
-        } else {
-          LocalWinner->SetDone(true);
-          CONT::vc[ContextID]->done();
-        }
+        LocalGroup->SetWinnerDone(LocalReqdProp, true);
+        CONT::vc[ContextID]->done();
         goto TerminateThisTask;
       }
     }
   }
 
   // Check that winner satisfies current context
-  if (CostSoFar >= *LocalUB) {
-    PTRACE("total cost too expensive: totalcost " << CostSoFar.Dump() << " >= upperbd " << LocalUB->Dump());
+  if (CostSoFar >= LocalUB) {
+    PTRACE("total cost too expensive: totalcost " << CostSoFar.Dump() << " >= upperbd " << LocalUB.Dump());
     goto TerminateThisTask;
   }
 
-  // compare cost to current winner for this context
-  // update the winner and upperbound accordingly
+  // Global epsilon pruning: a plan this cheap is good enough, so it is the final winner
+  if (GlobepsPruning && CostSoFar.GetValue() <= GLOBAL_EPS) {
+    PTRACE("total cost " << CostSoFar.Dump() << " within global epsilon, got a final winner for this context");
 
-  if (LocalWinner->GetMPlan() &&              // If there is already a non-null local winner
-      CostSoFar >= *(LocalWinner->GetCost())  // and current expression is more expensive
-  )
-    goto TerminateThisTask;  // Leave the non-null local winner alone
-  else {
-    // The expression being optimized is a new winner
+    if (LocalGroup->ImproveWinner(LocalReqdProp, MExpr, CostSoFar)) CONT::vc[ContextID]->SetUpperBound(CostSoFar);
+    LocalGroup->SetWinnerDone(LocalReqdProp, true);
+    CONT::vc[ContextID]->done();
+    OptStat->EpsWinner++;
+    goto TerminateThisTask;
+  }
 
-    Cost *WinCost = new Cost(CostSoFar);
-    LocalGroup->NewWinner(LocalReqdProp, MExpr, WinCost, Last);
+  // compare cost to current winner for this context
+  // update the winner and upperbound accordingly.
+  // If there is already a non-null local winner and current expression is
+  // more expensive, leave the non-null local winner alone.
+  if (LocalGroup->ImproveWinner(LocalReqdProp, MExpr, CostSoFar)) {
+    // The expression being optimized is a new winner
 
     // update the upperbound of the current context
     CONT::vc[ContextID]->SetUpperBound(CostSoFar);
 
     PTRACE("New winner, update upperBd : " << CostSoFar.Dump());
-    // delete CostSoFar;
-
-    goto TerminateThisTask;
   }
+  goto TerminateThisTask;
 
 TerminateThisTask:
 
   PTRACE("OptimizeInputTask this task is terminating.");
   // delete (void*) CostSoFar;
-
-  // if this is the last task in the group, set the localwinner done=true
-  if (Last) {
-    LocalWinner = LocalGroup->GetWinner(LocalReqdProp);
-    LocalWinner->SetDone(true);
-    MExression *TempME = LocalWinner->GetMPlan();
-    PTRACE("Terminate: replaced winner with " << LocalReqdProp->Dump() << ", "
-                                              << (TempME ? TempME->Dump() : " nullptr ") << ", "
-                                              << LocalWinner->GetCost()->Dump());
-  }
-
-  if (Last)
-    // this's the last task for the group, so mark the group with completed optimizing
-    Ssp->GetGroup(MExpr->GetGrpID())->set_optimized(true);
-
-  // tasks must destroy themselves
-  delete this;
-
 }  // OptimizeInputTask::perform
 
 string OptimizeInputTask::Dump() {
@@ -817,44 +1063,35 @@ string OptimizeInputTask::Dump() {
   return os;
 }  // Dump
 
-ApplyRuleTask::ApplyRuleTask(Rule *rule, MExression *mexpr, bool explore, int ContextID, int parent_task_no, bool last)
-    : OptimizerTask(ContextID, parent_task_no), rule(rule), MExpr(mexpr), explore(explore), Last(last){};
-
-ApplyRuleTask::~ApplyRuleTask() {
-  if (Last) {
-    Group *group = Ssp->GetGroup(MExpr->GetGrpID());
-    if (!explore) {
-      CONT *LocalCont = CONT::vc[ContextID];
-      // What prop is required of
-      PHYS_PROP *LocalReqdProp = LocalCont->GetPhysProp();
-      WINNER *Winner = group->GetWinner(LocalReqdProp);
-
-      // if (Winner) assert(!Winner->GetDone());
-
-      // mark the winner as done
-      Winner->SetDone(true);
-      // this's still the last applied rule in the group,
-      // so mark the group with completed optimization or exploration
-      Ssp->GetGroup(MExpr->GetGrpID())->set_optimized(true);
-    } else
-      Ssp->GetGroup(MExpr->GetGrpID())->set_explored(true);
-  }
+// bindings of the ApplyRuleTask running on this thread, released when it ends
+static thread_local ARENA Scratch;
 
-};  // ApplyRuleTask::~ApplyRuleTask
+ApplyRuleTask::ApplyRuleTask(Rule *rule, MExression *mexpr, bool explore, int ContextID, int parent_task_no)
+    : OptimizerTask(ContextID, parent_task_no), rule(rule), MExpr(mexpr), explore(explore){};
 
 void ApplyRuleTask::perform() {
   CONT *Context = CONT::vc[ContextID];
 
   PTRACE("ApplyRuleTask performing, rule: " << rule->GetName() << " expression: " << MExpr->Dump());
   PTRACE("Context ID: " << ContextID << " , " << CONT::vc[ContextID]->Dump());
-  PTRACE("Last flag is " << Last);
 
   // if stop generating logical expression when epsilon prune is applied
   // if this context is done, stop
   // Check that this context is not done
   if (Context->is_done()) {
     PTRACE("Context: " << Context->GetPhysProp()->Dump() << " is done");
-    delete this;
+    return;
+  }
+
+  // another task may have fired it since this one was pushed
+  if (!MExpr->can_fire(rule->get_index())) {
+    PTRACE("rule already fired on " << MExpr->Dump());
+    return;
+  }
+
+  if (!rule->GetSubstitute()->GetOp()->is_physical() && Ssp->PastDeadline()) {
+    PTRACE("deadline passed, rule not fired");
+    OptStat->SkippedRule++;
     return;
   }
 
@@ -885,6 +1122,7 @@ void ApplyRuleTask::perform() {
   //     search space.
 
   // Loop over all Bindings of MExpr to the original pattern of the rule
+  ScratchArena = &Scratch;
   bindery = new BINDERY(MExpr, rule->GetOriginal());
   for (; bindery->advance(); delete before) {
     // There must be a Binding since advance() returned non-null.
@@ -913,48 +1151,59 @@ void ApplyRuleTask::perform() {
     // include substitute in MEMO, find duplicates, etc.
     int group_no = MExpr->GetGrpID();
 
+    // the search space outlives this task, nothing in it may come from the scratch arena
+    ScratchArena = nullptr;
     NewMExpr = Ssp->CopyIn(after, group_no);
+    ScratchArena = &Scratch;
 
     // If substitute was already known
     if (NewMExpr == nullptr) {
       PTRACE("duplicate substitute " << after->Dump());
+      OptStat->DupSubstitute++;
       delete after;  // "after" no longer used
       continue;      // try to find another substitute
     }
 
-    PTRACE("New Mexpr is : " << NewMExpr->Dump());
-    Memo_M_Exprs++;
-
     delete after;  // "after" no longer used
 
-    // Give this expression the rule's mask
-    NewMExpr->set_rule_mask(rule->get_mask());
-
-    // We need to handle this case for rules like project -> nullptr,
-    // by merging groups
-    assert(MExpr->GetGrpID() == NewMExpr->GetGrpID());
+    if (NewMExpr->GetGrpID() != group_no) {
+      // The substitute is in another group, equivalent to this one, which will
+      // be merged into it.  If that group has not been searched, fire the rules
+      // on its expressions as on new ones, so that this search covers both groups.
+      PTRACE("substitute found in group " << NewMExpr->GetGrpID() << " : " << NewMExpr->Dump());
+      Group *Other = Ssp->GetGroup(NewMExpr->GetGrpID());
+      PHYS_PROP AnyProp(any);
+      WINNER *Winner = Other->GetWinner(&AnyProp);
+      if (Other->is_optimized() || (Winner && !Winner->GetDone()) ||
+          (explore && (Other->is_explored() || Other->is_exploring())))
+        continue;
 
-    bool Flag = false;
-    if (Last)
-    // this's the last applied rule in the group,pass it to the new task
-    {
-      Last = false;  // turn off this, since it's no longer the last task
-      Flag = true;
+      for (MExression *LogMExpr = Other->GetFirstLogMExpr(); LogMExpr; LogMExpr = LogMExpr->GetNextMExpr()) {
+        PTRACE("pushing OptimizeExprTask " << (explore ? "exploring" : "optimizing") << " expr: " << LogMExpr->Dump());
+        PTasks.push(new OptimizeExprTask(LogMExpr, explore, ContextID, TaskNo));
+      }
+      continue;
     }
 
+    PTRACE("New Mexpr is : " << NewMExpr->Dump());
+    Memo_M_Exprs++;
+
+    // Give this expression the rule's mask
+    NewMExpr->add_rule_mask(rule->get_mask());
+
     // follow-on tasks
     if (explore)  // optimizer is exploring, the new mexpr must be logical expr
     {
       assert(NewMExpr->GetOp()->is_logical());
       PTRACE("new task to explore new expression, pushing OptimizeExprTask exploring expr: " << NewMExpr->Dump());
-      PTasks.push(new OptimizeExprTask(NewMExpr, true, ContextID, TaskNo, Flag));
+      PTasks.push(new OptimizeExprTask(NewMExpr, true, ContextID, TaskNo));
     }     // optimizer is exploring
     else  // optimizer is optimizing
     {
       // for a logical op, try further transformations
       if (NewMExpr->GetOp()->is_logical()) {
         PTRACE("new task to optimize new expression,pushing OptimizeExprTask, expr: " << NewMExpr->Dump());
-        PTasks.push(new OptimizeExprTask(NewMExpr, false, ContextID, TaskNo, Flag));
+        PTasks.push(new OptimizeExprTask(NewMExpr, false, ContextID, TaskNo));
       }  // further transformations to optimize new expr
       else {
         // for a physical operator, optimize the inputs
@@ -962,7 +1211,7 @@ void ApplyRuleTask::perform() {
         assert(NewMExpr->GetOp()->is_physical());
 
         PTRACE("new task to optimize inputs,pushing O_INPUT, epxr: " << NewMExpr->Dump());
-        PTasks.push(new OptimizeInputTask(NewMExpr, ContextID, TaskNo, Flag));
+        PTasks.push(new OptimizeInputTask(NewMExpr, ContextID, TaskNo));
 
       }  // for a physical operator, optimize the inputs
 
@@ -971,12 +1220,11 @@ void ApplyRuleTask::perform() {
   }  // try all possible bindings
 
   delete bindery;
+  ScratchArena = nullptr;
+  Scratch.reset();
 
   // Mark rule vector to show that this rule has fired
   MExpr->fire_rule(rule->get_index());
-
-  // tasks must destroy themselves
-  delete this;
 }
 
 string ApplyRuleTask::Dump() {
@@ -9,18 +9,45 @@
 /* number of slots in a (locally defined) array */
 #define slotsof(ARRAY) (sizeof(ARRAY) / sizeof(ARRAY[0]))
 
+/* inputs kept in an MExression or an OptimizeInputTask itself, more are allocated */
+#define INLINE_ARITY 2
+
 // needed for hashing, used for duplicate elimination.
 // See ../doc/dupelim and ../doc/dupelim.pcode
-#define LOG2HTBL 13               // LOG2 of number of hash buckets to hold mexprs.
-#define HtblSize (1 << LOG2HTBL)  // hash table size we used
-typedef unsigned long int ub4;    /* unsigned 4-byte quantities */
-typedef unsigned char ub1;        /* unsigned 1-byte quantities */
+typedef unsigned long int ub4; /* unsigned 4-byte quantities */
+typedef unsigned char ub1;     /* unsigned 1-byte quantities */
 
 typedef vector<string> STRING_ARRAY;
 typedef vector<int> INT_ARRAY;
-
-typedef unsigned int BIT_VECTOR;  // Used to implement unique rule set.  Note this
-// restricts the number of transformational (logical) rules.
+typedef vector<atomic<int>> COUNTER_ARRAY;  // counted by all the worker threads
+
+/*
+This enum list indexes the rule set and the rule bit vectors (BIT_VECTOR, R_END bits).
+It must be consistent with rule_set and with the rule set file read from disk.
+*/
+typedef enum RULELABELS {
+  R_GET_TO_FILE_SCAN,
+  R_SELECT_TO_FILTER,
+  R_P_TO_PP,
+  R_EQ_TO_LOOPS_INDEX,
+  R_EQ_TO_MERGE,
+  R_EQ_TO_LOOPS,
+  R_SORT_RULE,
+  R_EQJOIN_COMMUTE,
+  R_EQJOIN_LTOR,
+  R_EQJOIN_RTOL,
+  R_EXCHANGE,
+  R_RM_TO_HASH_DUPLICATES,
+  R_AL_TO_HGL,
+  R_FO_TO_PFO,
+  R_AGG_THRU_EQJOIN,
+  R_EQ_TO_BIT,
+  R_SELECT_TO_INDEXED_FILTER,
+  R_PROJECT_THRU_SELECT,
+  R_EQ_TO_HASH,
+  R_DUMMY_TO_PDUMMY,
+  R_END,
+} RULELABELS;
 
 extern bool ForGlobalEpsPruning;  // If true, we are running the optimizer to get an
 // estimated cost to use for global epsilon pruning.
@@ -46,41 +73,99 @@ typedef enum ORDER_INDEX {
 // e.g. sum(xxx) as .SUM, whose domain is unknown
 typedef enum DOM_TYPE { string_t, int_t, real_t, unknown } DOM_TYPE;
 
-#define PTRACE(object)                                                                                               \
-  {                                                                                                                  \
-    OutputFile << TraceDepth << ":" << setiosflags(ios::right) << setw(12) << __FILE__ << ":" << setw(4) << __LINE__ \
-               << setiosflags(ios::right) << setw(8) << ">>>>>: " << object << endl;                                 \
+// How the orders of a block of joins are enumerated (set by --join-enum), see JoinEnumerator
+//   rules: by the join reordering rules, like any other transformation
+//   dpccp: all at once by DPccp, before the search; the rules skip those groups
+//   goo:   one greedy bushy tree, before the search
+//   random: the best tree of a randomized search, before the search
+// Otherwise, blocks of more than GooThreshold relations get the greedy tree.
+typedef enum JOIN_ENUM { JOIN_RULES, JOIN_DPCCP, JOIN_GOO, JOIN_RANDOM } JOIN_ENUM;
+
+// Masks of the join reordering rules (set by --join-rules)
+//   rs-b2: the rule set RS-B2 of Pellenkoft, Galindo-Legaria and Kersten, The
+//          Complexity of Transformation-Based Join Enumeration, VLDB 1997.  Each
+//          rule turns off the rules on its substitute which would make a join
+//          order again, so each join order is made once.
+//   rs-b0: no masks.  The rules make join orders over and over, and the
+//          duplicate table drops them; to measure what the masks save.
+typedef enum JOIN_RULE_SET { RS_B2, RS_B0 } JOIN_RULE_SET;
+
+// Cartesian products EQJOIN_LTOR, EQJOIN_RTOL and EXCHANGE may make (set by --cartesian)
+//   allow:    all of them
+//   original: only when the joins they reorder have one already
+//   forbid:   none
+//   card:     those of at most CartesianMaxCard tuples (set by --cartesian-card)
+typedef enum CARTESIAN { CART_ALLOW, CART_ORIGINAL, CART_FORBID, CART_CARD } CARTESIAN;
+
+// Trace levels, from least to most verbose.  A message is written when its
+// level is compiled in (TRACE_MAX_LEVEL, set by the TRACE_LEVEL cmake option)
+// and enabled at runtime (TraceLevel, set by --trace).  The arguments of a
+// disabled message are never evaluated; above TRACE_MAX_LEVEL the condition is
+// a constant and the compiler drops the message entirely.
+//   error: OUTPUT_ERROR
+//   info:  OUTPUT, OUTPUTN - statistics and the final plan
+//   debug: PTRACE, OUTPUT_DEBUG - the search step by step, memo dumps
+//   cove:  COVE - the script for the COVE visualizer
+typedef enum TRACE_LEVEL { TRACE_OFF, TRACE_ERROR, TRACE_INFO, TRACE_DEBUG, TRACE_COVE } TRACE_LEVEL;
+
+#ifndef TRACE_MAX_LEVEL
+#define TRACE_MAX_LEVEL TRACE_COVE
+#endif
+
+#define TRACING(level) ((level) <= TRACE_MAX_LEVEL && (level) <= TraceLevel)
+
+// Worker threads share the output files.  A line is formatted first, then
+// written under TraceLock, so lines do not interleave and no other lock is
+// ever taken while holding TraceLock.
+#define TRACE_LINE(level, stream, object)        \
+  {                                              \
+    if (TRACING(level)) {                        \
+      ostringstream TraceLine;                   \
+      TraceLine << object << endl;               \
+      lock_guard<mutex> TraceGuard(TraceLock);   \
+      stream << TraceLine.str() << flush;        \
+    }                                            \
   }
 
+// Write a line to OutputFile, prefixed with where it comes from
+#define PTRACE(object)                                                                                  \
+  TRACE_LINE(TRACE_DEBUG, OutputFile,                                                                   \
+             TraceDepth << ":" << setiosflags(ios::right) << setw(12) << __FILE__ << ":" << setw(4)     \
+                        << __LINE__ << setiosflags(ios::right) << setw(8) << ">>>>>: " << object)
+
 // Print n tabs, then the character string.  No newlines except as in string.
-#define OUTPUTN(n, str)                                       \
-  {                                                           \
-    string OutputString;                                      \
-    OutputString = "    ";                                    \
-    for (int i = 0; i < n; i++) OutputString += OutputString; \
-    OutputString += str;                                      \
-    OutputFile << (OutputString);                             \
+#define OUTPUTN(n, str)                                         \
+  {                                                             \
+    if (TRACING(TRACE_INFO)) {                                  \
+      string OutputString(4 * ((n) + 1), ' ');                  \
+      OutputString += str;                                      \
+      lock_guard<mutex> TraceGuard(TraceLock);                  \
+      OutputFile << (OutputString);                             \
+    }                                                           \
   }
 
-// Output the object to window and OutputFile, even if tracing is off.
-// No newlines except in format input.
-// First one writes to window and trace file, second to file only.
-#define OUTPUT(object)                \
-  {                                   \
-    { OutputFile << object << endl; } \
-  }
+// Output the object to OutputFile.  No newlines except in format input.
+#define OUTPUT(object) TRACE_LINE(TRACE_INFO, OutputFile, object)
 
-// display error message to Window and OutputFile
-#define OUTPUT_ERROR(text)                                                                                \
-  {                                                                                                       \
-    OutputFile << "\r\nERROR:" << text << ",file:" << (__FILE__) << ",line:" << __LINE__ << "\n" << endl; \
-    abort();                                                                                              \
+// Output the object to OutputFile when debugging, e.g. dumps of the memo
+#define OUTPUT_DEBUG(object) TRACE_LINE(TRACE_DEBUG, OutputFile, object)
+
+// Write a line to the COVE script, if we are doing COVE tracing
+#define COVE(object) TRACE_LINE(TRACE_COVE, OutputCOVE, object)
+
+// display error message to OutputFile and give up
+#define OUTPUT_ERROR(text)                                                                                    \
+  {                                                                                                           \
+    if (TRACING(TRACE_ERROR))                                                                                 \
+      OutputFile << "\r\nERROR:" << text << ",file:" << (__FILE__) << ",line:" << __LINE__ << "\n" << endl; \
+    abort();                                                                                                  \
   }
 
 /* ==========  Optimizer related ============  */
 
 class Query;
-class OptimizerTaskStack;
+class TaskScheduler;
+class OptimizerTask;
 class SearchSpace;
 class CAT;
 class Rule;
@@ -89,25 +174,28 @@ class RuleSet;
 class CostModel;
 class KEYS_SET;
 class MExression;
+class ARENA;
+class SYMBOL_TABLE;
 
 extern OPT_STAT *OptStat;  // stat. info. of Optimizer
 extern int CLASS_NUM;
 
-extern INT_ARRAY TopMatch;
-extern INT_ARRAY Bindings;
-extern INT_ARRAY Conditions;
+extern COUNTER_ARRAY TopMatch;
+extern COUNTER_ARRAY Bindings;
+extern COUNTER_ARRAY Conditions;
 
-extern STRING_ARRAY CollTable;    // collection name table
-extern STRING_ARRAY AttTable;     // attribute name table
-extern STRING_ARRAY IndTable;     // index name table
+extern SYMBOL_TABLE CollTable;    // collection name table
+extern SYMBOL_TABLE AttTable;     // attribute name table
+extern SYMBOL_TABLE IndTable;     // index name table
 extern INT_ARRAY AttCollTable;    // attribute to collid table
-extern STRING_ARRAY BitIndTable;  // Bitind name table
+extern SYMBOL_TABLE BitIndTable;  // Bitind name table
 
 extern ofstream OutputFile;  // global output file
 extern ofstream OutputCOVE;  // global COVE script file
+extern mutex TraceLock;      // guards writes to OutputFile and OutputCOVE
 extern int TraceDepth;       // Not the stack depth, but the number of times SET_TRACE
 // objects have been created in current stack functions.
-extern bool COVETrace;        // Are we doing COVE tracing?
+extern TRACE_LEVEL TraceLevel;  // most verbose trace level written at runtime
 extern bool Pruning;          // global pruning flag
 extern bool CuCardPruning;    // global cucard pruning flag
 extern int RadioVal;          // Radio value for queryfile
@@ -116,15 +204,29 @@ extern bool SingleLineBatch;  // Should output of batch queries be one line per
 extern bool Halt;         // halt flat
 extern int HaltGrpSize;   // halt when number of plans equals to 100% of group
 extern int HaltWinSize;   // window size for checking the improvement
-extern int TaskNo;        // Number of the current task.
-extern int Memo_M_Exprs;  // How Many M_EXPRs in the MEMO Structure?
-
-extern double GLOBAL_EPS;  // global epsilon value
-
-extern int printnx;
+extern int DeadlineMs;    // anytime mode: stop transforming after this many ms of optimization, 0 for none
+extern atomic<int> TaskNo;         // Number of the current task.
+extern int Threads;                // number of worker threads running optimizer tasks
+extern JOIN_ENUM JoinEnum;         // how join orders are enumerated
+extern JOIN_RULE_SET JoinRuleSet;  // masks of the join reordering rules
+extern CARTESIAN Cartesian;        // Cartesian products the join reordering rules may make
+extern double CartesianMaxCard;    // largest Cartesian product made under CART_CARD
+extern int GooThreshold;           // join blocks with more relations are ordered greedily, 0 for never
+extern int RandomMaxMoves;         // moves tried by the randomized join search of a block
+extern int RandomMaxMs;            // time allowed to the randomized join search of a block, 0 for no limit
+extern unsigned RandomSeed;        // seed of the randomized join search
+extern atomic<int> Memo_M_Exprs;   // How Many M_EXPRs in the MEMO Structure?
+
+extern double GLOBAL_EPS;        // global epsilon value
+extern bool GlobepsPruning;      // a plan costing at most GLOBAL_EPS wins its context at once
+extern double GlobalEpsPercent;  // GLOBAL_EPS, in percent of the cost of the seed plan
+extern bool SeedBound;           // bound the root context by the cost of a seed plan found first
+
+extern thread_local int printnx;  // indentation of Expression::Dump, per thread
+extern thread_local ARENA *ScratchArena;  // arena of the task running on this thread, if it has one
 
 extern Query *query;
-extern OptimizerTaskStack PTasks;
+extern TaskScheduler PTasks;
 extern SearchSpace *Ssp;
 extern CAT *Cat;
 extern RuleSet *ruleSet;
@@ -2,20 +2,29 @@
 #include "op.h"
 #include "stdafx.h"
 
+// A binding (see BINDERY) is an Expression whose operators are those of the
+// mexprs bound, borrowed from the search space rather than cloned.  Rules
+// only read them, and copying a subtree of a binding into a substitute
+// clones its operators as usual.
 class Expression {
  private:
   Operator *oper;
   vector<Expression *> children_;
+  bool Borrowed;  // is oper an operator of the search space, not deleted with me
 
  public:
-  Expression(Operator *op, vector<Expression *> &&child) : oper(op), children_(child){};
+  Expression(Operator *op, vector<Expression *> &&child, bool Borrowed = false)
+      : oper(op), children_(child), Borrowed(Borrowed){};
 
-  Expression(Expression &Expr) : oper(Expr.GetOp()->Clone()) {
+  Expression(Expression &Expr) : oper(Expr.GetOp()->Clone()), Borrowed(false) {
     for (int i = 0; i < Expr.GetArity(); i++) children_.push_back(new Expression(*(Expr.GetInput(i))));
   };
 
+  static void *operator new(size_t size) { return ScratchAlloc(size); };
+  static void operator delete(void *p, size_t size) { ScratchFree(p, size); };
+
   ~Expression() {
-    delete oper;
+    if (!Borrowed) delete oper;
     for (auto &&child : children_) delete child;
     children_.clear();
   };
@@ -2,14 +2,13 @@
 #include "../header/physop.h"
 #include "../header/tasks.h"
 
-// Each array maps an integer into the elements of the array at that integer
-// location, i.e. maps i to array[i].
+// Each table maps an id to its name and back, AttCollTable maps an AttId to its CollId.
 // These should probably be in CAT
-STRING_ARRAY CollTable;    // CollId to char* name of collection
-STRING_ARRAY AttTable;     // AttId to char* name of attribute (including coll name)
-STRING_ARRAY IndTable;     // IndId to CollId
+SYMBOL_TABLE CollTable;    // names of collections
+SYMBOL_TABLE AttTable;     // names of attributes (including coll name)
+SYMBOL_TABLE IndTable;     // names of indexes (including coll name)
 INT_ARRAY AttCollTable;    // AttId to CollId
-STRING_ARRAY BitIndTable;  //	BitIndex name table
+SYMBOL_TABLE BitIndTable;  // names of bit indexes (including coll name)
 
 string SQueryFile = "query";   // query file name
 string BQueryFile = "bquery";  // query file for batch queries
@@ -18,9 +17,9 @@ string CMFile = "cm";          // cost model file name
 string AppDir;                 // directory of the application
 
 bool PiggyBack = false;  // Retain the MEMO structure for use in the subsequent optimization
-bool COVETrace = true;   // trace to file flag
 
-int printnx = 0;
+thread_local int printnx = 0;
+thread_local ARENA *ScratchArena = nullptr;
 
 bool Pruning = true;           // pruning flag
 bool CuCardPruning = true;     // cucard pruning flag
@@ -29,6 +28,16 @@ bool SingleLineBatch = false;  // Single line per query in batch mode
 bool Halt = false;             // halt flat
 int HaltGrpSize = 100;         // halt when number of plans equals to 100% of group
 int HaltWinSize = 3;           // window size for checking the improvement
+int DeadlineMs = 0;            // no deadline
+int Threads = 1;               // number of worker threads running optimizer tasks
+JOIN_ENUM JoinEnum = JOIN_RULES;    // join orders by the rules
+JOIN_RULE_SET JoinRuleSet = RS_B2;  // duplicate free join rules
+CARTESIAN Cartesian = CART_ALLOW;   // every Cartesian product
+double CartesianMaxCard = 10000;    // tuples of a Cartesian product under CART_CARD
+int GooThreshold = 16;              // greedy join order above 16 relations
+int RandomMaxMoves = 10000;         // moves tried by the randomized join search of a block
+int RandomMaxMs = 0;                // no time limit
+unsigned RandomSeed = 1;            // seed of the randomized join search
 
 // GLOBAL_EPS can also be set by the options window.
 // GLOBAL_EPS is typically determined as a small percentage of
@@ -38,8 +47,12 @@ double GLOBAL_EPS = 0.5;  // global epsilon value
 // if GlobalepsPruning is not set, this value is 0
 // otherwise, this value will be reset in main
 bool ForGlobalEpsPruning = false;
+bool GlobepsPruning = false;    // set by --global-eps
+double GlobalEpsPercent = 1;    // GLOBAL_EPS is 1% of the cost of the seed plan
+bool SeedBound = false;         // set by --seed-bound
 
-int TraceDepth = 0;  // global Trace depth
+int TraceDepth = 0;                   // global Trace depth
+TRACE_LEVEL TraceLevel = TRACE_INFO;  // statistics and plan only, see --trace
 
 class OPT_STAT *OptStat;  // Opt statistics object
 
@@ -52,4 +65,5 @@ KEYS_SET IntOrdersSet;  // set of interesting orders
 
 ofstream OutputFile;        // result file
 ofstream OutputCOVE;        // script file
-OptimizerTaskStack PTasks;  // pending task
+mutex TraceLock;            // guards writes to both files
+TaskScheduler PTasks;  // pending task
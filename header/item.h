@@ -44,10 +44,9 @@ class ATTR_OP : public ItemOperator {
   LOG_PROP *FindLogProp(LOG_PROP **input);
 
   inline int get_value() { return AttId; }
-  inline int GetArity() { return (0); };
-  inline string GetName() { return ("ATTR_OP"); };
+  inline OPCODE GetOpcode() { return OPCODE::ATTR_OP; };
   inline bool is_const() { return true; };
-  inline Cost *get_cost() { return new Cost(0); };
+  inline Cost get_cost() { return Cost(0); };
 
   string Dump() { return "Attribute(" + GetAttName(AttId) + ")"; }
 };
@@ -74,12 +73,11 @@ class ATTR_EXP : public ItemOperator {
   };
 
   // inline int Get_AttId() { return (AttNew->AttId); };
-  inline int GetArity() { return (0); };
   inline int *GetAtts() { return (Atts); };
   inline int GetAttsSize() { return (AttsSize); };
   inline string GetRangeVar() { return (RangeVar); };
   inline Attribute *GetAttNew() { return (AttNew); };
-  inline string GetName() { return ("ATTR_EXP"); };
+  inline OPCODE GetOpcode() { return OPCODE::ATTR_EXP; };
 
   string Dump();
 };
@@ -88,7 +86,7 @@ class ATTR_EXP : public ItemOperator {
 class CONST_OP : public ItemOperator {
  public:
   inline bool is_const() { return true; };
-  Cost *get_cost() { return new Cost(0); };
+  Cost get_cost() { return Cost(0); };
 };
 
 // Integer valued constant
@@ -107,8 +105,7 @@ class CONST_INT_OP : public CONST_OP {
   ~CONST_INT_OP(){};
 
   inline int get_value() { return value; }
-  inline int GetArity() { return (0); };
-  inline string GetName() { return ("INT_OP"); };
+  inline OPCODE GetOpcode() { return OPCODE::INT_OP; };
   inline bool is_const() { return true; };
   // inline Cost * get_cost() { return new Cost(0); };
 
@@ -133,8 +130,7 @@ class CONST_STR_OP : public CONST_OP {
   LOG_PROP *FindLogProp(LOG_PROP **input);
 
   inline string get_value() { return value; }
-  inline int GetArity() { return (0); };
-  inline string GetName() { return ("STR_OP"); };
+  inline OPCODE GetOpcode() { return OPCODE::STR_OP; };
   inline bool is_const() { return true; };
   // inline Cost * get_cost() { return new Cost(0); };
 
@@ -158,8 +154,7 @@ class CONST_SET_OP : public CONST_OP {
   ~CONST_SET_OP(){};
 
   inline string get_value() { return value; }
-  inline int GetArity() { return (0); };
-  inline string GetName() { return ("SET_OP"); };
+  inline OPCODE GetOpcode() { return OPCODE::SET_OP; };
   inline bool is_const() { return true; };
   // inline Cost * get_cost() { return new Cost(0); };
 
@@ -214,7 +209,7 @@ class COMP_OP : public BOOLE_OP {
       return (2);
   };
 
-  inline string GetName() { return ("COMP_OP"); };
+  inline OPCODE GetOpcode() { return OPCODE::COMP_OP; };
 
   string Dump() {
     string os;
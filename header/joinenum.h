@@ -0,0 +1,146 @@
+// joinenum.h - join enumeration outside the rules
+
+#pragma once
+#include "ssp.h"
+
+#define MAX_JOIN_RELATIONS 64  // relations of a join block, one bit each in a JoinEnumerator::SET
+
+// Randomized search, with n the number of relations of the block
+#define LOCAL_MINIMUM 4          // iterative improvement stops after 4n moves in a row fail
+#define START_TEMPERATURE 0.1    // of the cost at that local minimum
+#define COOLING 0.95             // temperature kept after each stage of n moves
+#define FROZEN 1e-4              // annealing restarts from the best tree below this temperature, relative to its cost
+
+/*
+   ============================================================
+   JoinEnumerator
+   ============================================================
+   An alternative to the join transformation rules (EQJOIN_COMMUTE,
+   EQJOIN_LTOR, EQJOIN_RTOL and EXCHANGE) for blocks of EQJOINs.  The rules
+   reach each join order many times over, and most mexprs they make are
+   duplicates.
+
+   A join block is a tree of EQJOINs in the initial query.  Its relations
+   are the inputs of the block which are not EQJOINs themselves, and the
+   edges of its join graph are the join predicates.  Before the search, the
+   join orders of each block are copied into the memo by one of
+
+   DPccp - enumerates each pair of a connected set of relations and a
+   connected complement joined to it exactly once (Moerkotte and Neumann,
+   Analysis of Two Existing and One New Dynamic Programming Algorithm for
+   the Generation of Optimal Bushy Join Trees without Cross Products, VLDB
+   2006), and copies both join orders of the pair into the group of their
+   union.  The pairs come in an order where the groups of both sides
+   already exist.  The groups of the block then hold all their join orders.
+
+   GOO - greedy operator ordering (Fegaras, A New Heuristic for Optimizing
+   Large Queries, DEXA 1998): starting from the relations, repeatedly joins
+   the two connected trees whose join has the smallest estimated
+   cardinality, until one tree is left.  This is the one bushy tree used
+   for blocks of more than GooThreshold relations, where any exhaustive
+   search is hopeless.
+
+   Randomized - two phase optimization (Ioannidis and Kang, Randomized
+   Algorithms for Optimizing Large Join Queries, SIGMOD 1990): starting from
+   the tree of the query, iterative improvement applies random moves and
+   keeps those which lower the cost, until it reaches a local minimum;
+   simulated annealing then goes on from there, also taking moves which
+   raise the cost with a probability falling with the temperature.  Once it
+   is frozen both phases start over from the best tree.  The
+   moves are those of EQJOIN_COMMUTE, EQJOIN_LTOR, EQJOIN_RTOL and EXCHANGE,
+   plus the left and right join exchanges, and a tree costs the sum of the
+   HASH_JOIN::FindLocalCost of its joins.
+   RandomMaxMoves and RandomMaxMs bound the search whatever the size of the
+   block, and RandomSeed makes it repeatable.  The best tree found is copied
+   in.
+
+   The groups are marked enumerated and the join reordering rules are not
+   fired on them; all other rules are, and OptimizeInputTask costs them as
+   usual.  In anytime mode (DeadlineMs) the groups made by GOO or the
+   randomized search are not marked, so the rules improve on their tree
+   until the deadline.
+   Cartesian products are never considered.  A block with more than
+   MAX_JOIN_RELATIONS relations, or a predicate which does not join two of
+   its relations, is left to the rules.
+*/
+
+class JoinEnumerator {
+ private:
+  typedef uint64_t SET;  // a set of relations, bit i for relation i
+
+  struct PREDICATE {
+    int LeftAtt, RightAtt;
+    int Left, Right;  // the relations of the attributes
+  };
+
+  // A join tree of the randomized search.  Relation i is node i, the joins follow.
+  struct NODE {
+    int Left, Right;  // inputs of a join, -1 for a relation
+  };
+  typedef vector<NODE> TREE;
+
+  vector<int> Relations;            // group of each relation
+  vector<SET> Neighbors;            // relations joined to each relation
+  vector<PREDICATE> Predicates;
+  vector<EQJOIN *> Joins;           // the EQJOINs of the block
+  unordered_map<SET, int> Groups;   // group of each connected set of relations copied in so far
+  int Pairs;                        // pairs of sets joined, both ways
+
+  // estimates of the randomized search, for sets of relations without a group
+  unordered_map<SET, LOG_PROP *> Props;
+  map<pair<SET, SET>, double> LocalCosts;
+  mt19937 Random;
+
+  // collect the relations and the joins of the block under GrpID, return its relations
+  SET Collect(int GrpID);
+  // find the relations of the predicates, false if one does not join two relations
+  bool Connect();
+  int Relation(int AttId);
+
+  // relations joined to S, but not in S or X
+  SET Neighborhood(SET S, SET X);
+  // relations with an index up to i
+  inline SET Below(int i) { return (i >= 63) ? ~(SET)0 : (((SET)1 << (i + 1)) - 1); };
+
+  void EnumerateCsgRec(SET S1, SET X);
+  void EmitCsg(SET S1);
+  void EnumerateCmpRec(SET S1, SET S2, SET X);
+  void EmitCsgCmp(SET S1, SET S2);
+
+  // the EQJOIN of Left and Right, with the predicates between them
+  EQJOIN *MakeJoin(SET Left, SET Right);
+  // estimated cardinality of the join of Left and Right
+  float JoinCard(SET Left, SET Right);
+  // copy EQJOIN(Left, Right) into the group of Left | Right
+  void Join(SET Left, SET Right);
+
+  // logical properties of a set of relations met by the randomized search
+  LOG_PROP *Prop(SET S);
+  // the tree of the block under GrpID, in the order of Collect
+  int Original(int GrpID, TREE &Tree, int &NextRelation);
+  // logical properties of the join of Left and Right
+  LOG_PROP *JoinProp(SET Left, SET Right);
+  // cost of the subtree at Node, HUGE_VAL if one of its joins has no predicate
+  double TreeCost(TREE &Tree, int Node, SET &Relations);
+  // apply a random move to Tree, false if none applies at the join chosen
+  bool Move(TREE &Tree);
+  // copy the joins of the subtree at Node into the memo
+  SET CopyTree(TREE &Tree, int Node);
+
+  JoinEnumerator() : Pairs(0), Random(RandomSeed){};
+  ~JoinEnumerator();
+  // copy in the join orders of the block rooted at GrpID, as chosen by JoinEnum and GooThreshold.
+  // False if GrpID does not root a block it can order.
+  bool Enumerate(int GrpID);
+  void DPccp();
+  void Greedy();
+  bool Randomized(int GrpID);
+  // mark the groups made for the block enumerated
+  void Enumerated();
+
+ public:
+  // enumerate every join block of the search space under GrpID, by JoinEnum and GooThreshold
+  static void EnumerateAll(int GrpID);
+  // is RuleNo one of the join reordering rules, which a JoinEnumerator stands in for
+  static bool Reorders(int RuleNo);
+};
@@ -1,15 +1,6 @@
 #pragma once
 #include "op.h"
 
-#define GET_ID 1111  // log_op name id for hash or compare
-#define EQJOIN_ID 2222
-#define PROJECT_ID 3333
-#define SELECT_ID 4444
-#define RM_DUPLICATES_ID 5555
-#define AGG_LIST_ID 6666
-#define FUNC_OP_ID 7777
-#define DUMMY_ID 8888
-
 class GET;
 class SELECT;
 class PROJECT;
@@ -43,12 +34,10 @@ class GET : public LogicalOperator {
 
   LOG_PROP *FindLogProp(LOG_PROP **input);
 
-  inline int GetArity() { return (0); };
-  inline string GetName() { return ("GET"); };
-  inline int GetNameId() { return GET_ID; };
+  inline OPCODE GetOpcode() { return OPCODE::GET; };
   inline int GetCollection() { return CollId; };
   inline bool operator==(Operator *other) {
-    return (other->GetNameId() == GetNameId() && ((GET *)other)->CollId == CollId &&
+    return (other->GetOpcode() == GetOpcode() && ((GET *)other)->CollId == CollId &&
             ((GET *)other)->RangeVar == RangeVar);
   };
 
@@ -95,11 +84,9 @@ class EQJOIN : public LogicalOperator {
 
   LOG_PROP *FindLogProp(LOG_PROP **input);
 
-  inline int GetArity() { return (2); };           // Inputs are left and right streams
-  inline string GetName() { return ("EQJOIN"); };  // Name of this operator
-  inline int GetNameId() { return EQJOIN_ID; };    // Name of this operator
+  inline OPCODE GetOpcode() { return OPCODE::EQJOIN; };
   inline bool operator==(Operator *other) {
-    return (other->GetNameId() == GetNameId() &&
+    return (other->GetOpcode() == GetOpcode() &&
             EqualArray(((EQJOIN *)other)->lattrs, lattrs, size) &&  // arguments are equal
             EqualArray(((EQJOIN *)other)->rattrs, rattrs, size));
   };
@@ -130,10 +117,8 @@ class DUMMY : public LogicalOperator {
 
   LOG_PROP *FindLogProp(LOG_PROP **input);
 
-  inline int GetArity() { return (2); };          // Inputs are left and right streams
-  inline string GetName() { return ("DUMMY"); };  // Name of this operator
-  inline int GetNameId() { return DUMMY_ID; };    // Name of this operator
-  inline bool operator==(Operator *other) { return (other->GetNameId() == GetNameId()); };
+  inline OPCODE GetOpcode() { return OPCODE::DUMMY; };
+  inline bool operator==(Operator *other) { return (other->GetOpcode() == GetOpcode()); };
 
   ub4 hash();
 
@@ -160,10 +145,8 @@ class SELECT : public LogicalOperator {
 
   LOG_PROP *FindLogProp(LOG_PROP **input);
 
-  inline int GetArity() { return (2); };           // For input and predicate
-  inline string GetName() { return ("SELECT"); };  // Name of this operator
-  inline int GetNameId() { return SELECT_ID; };    // Name of this operator
-  inline bool operator==(Operator *other) { return (other->GetNameId() == GetNameId()); }
+  inline OPCODE GetOpcode() { return OPCODE::SELECT; };
+  inline bool operator==(Operator *other) { return (other->GetOpcode() == GetOpcode()); }
 
   ub4 hash();
 
@@ -191,11 +174,9 @@ class PROJECT : public LogicalOperator {
 
   LOG_PROP *FindLogProp(LOG_PROP **input);
 
-  inline int GetArity() { return (1); };  // Only input is the stream of bytes.  What to project is an argument, pattrs
-  inline string GetName() { return ("PROJECT"); };  // Name of this operator
-  inline int GetNameId() { return PROJECT_ID; };    // Name of this operator
+  inline OPCODE GetOpcode() { return OPCODE::PROJECT; };
   inline bool operator==(Operator *other) {
-    return (other->GetNameId() == GetNameId() &&
+    return (other->GetOpcode() == GetOpcode() &&
             EqualArray(((PROJECT *)other)->attrs, attrs, size));  // arguments are equal
   };
 
@@ -224,10 +205,8 @@ class RM_DUPLICATES : public LogicalOperator {
 
   LOG_PROP *FindLogProp(LOG_PROP **input);
 
-  inline int GetArity() { return (1); };                  // Only input is the stream of bytes.
-  inline string GetName() { return ("RM_DUPLICATES"); };  // Name of this operator
-  inline int GetNameId() { return RM_DUPLICATES_ID; };    // Name of this operator
-  inline bool operator==(Operator *other) { return (other->GetNameId() == GetNameId()); };
+  inline OPCODE GetOpcode() { return OPCODE::RM_DUPLICATES; };
+  inline bool operator==(Operator *other) { return (other->GetOpcode() == GetOpcode()); };
 
   // since this operator has arguments
   ub4 hash();
@@ -284,9 +263,7 @@ class AGG_LIST : public LogicalOperator {
 
   LOG_PROP *FindLogProp(LOG_PROP **input);
 
-  inline int GetArity() { return (1); };             // Only input is the stream of bytes.
-  inline string GetName() { return ("AGG_LIST"); };  // Name of this operator
-  inline int GetNameId() { return AGG_LIST_ID; };    // Name of this operator
+  inline OPCODE GetOpcode() { return OPCODE::AGG_LIST; };
   bool operator==(Operator *other);
 
   // since this operator has arguments
@@ -320,11 +297,9 @@ class FUNC_OP : public LogicalOperator {
 
   LOG_PROP *FindLogProp(LOG_PROP **input);
 
-  inline int GetArity() { return (1); };
-  inline string GetName() { return ("FUNC_OP"); };
-  inline int GetNameId() { return FUNC_OP_ID; };
+  inline OPCODE GetOpcode() { return OPCODE::FUNC_OP; };
   inline bool operator==(Operator *other) {
-    return (other->GetNameId() == GetNameId() &&
+    return (other->GetOpcode() == GetOpcode() &&
             EqualArray(((FUNC_OP *)other)->Atts, Atts, AttsSize) &&  // arguments are equal
             ((FUNC_OP *)other)->RangeVar == RangeVar);
   };
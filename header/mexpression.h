@@ -6,19 +6,33 @@
 
 #define NEW_GRPID -1  // used by SearchSpace::CopyIn and MExression::MExressionmeans need to create a new group
 
+// The fields read by every task on the mexpr, which walk the group's list
+// and the inputs, come first, and the inputs of all operators but the rare
+// wide ones are kept inline, so visiting an mexpr touches one cache line.
 class MExression {
  private:
-  MExression *HashPtr;  // list within hash bucket
-  BIT_VECTOR RuleMask;  // If 1, do not fire rule with that index
-  Operator *Op;         // Operator
-  vector<int> children_;
-  int GrpID;  // I reside in this group
-
-  // link to the next mexpr in the same group
-  MExression *NextMExpr;
+  Operator *Op;  // Operator
+  // link to the next mexpr in the same group.  Set once the mexpr is
+  // complete, so tasks walk the group's lists while others append to them.
+  atomic<MExression *> NextMExpr;
+  int GrpID;                       // I reside in this group
+  int Arity;                       // of Op
+  int *Inputs;                     // the input groups, InlineInputs up to INLINE_ARITY
+  int InlineInputs[INLINE_ARITY];
+  ub4 HashVal;                     // hash of a logical mexpr, computed once by the constructor
+  ATOMIC_BIT_SET<R_END> RuleMask;  // If 1, do not fire rule with that index
+
+  void SetHash();
 
  public:
-  ~MExression() { delete Op; };
+  ~MExression() {
+    delete Op;
+    if (Inputs != InlineInputs) delete[] Inputs;
+  };
+
+  // mexprs live in the arenas of the search space
+  static void *operator new(size_t size);
+  static void operator delete(void *p, size_t size);
 
   // Transform an Expression into an MExression.  May involve creating new Groups.
   //  GrpID is the ID of the group where the MExression will be put.  If GrpID is
@@ -28,29 +42,33 @@ class MExression {
   MExression(MExression &other);
 
   inline Operator *GetOp() { return (Op); };
-  inline int GetInput(int i) const { return (children_[i]); };
+  inline int GetInput(int i) const { return (Inputs[i]); };
   inline int GetGrpID() { return (GrpID); };
-  inline int GetArity() { return (Op->GetArity()); };
-
-  inline MExression *GetNextHash() { return HashPtr; };
-  inline void SetNextHash(MExression *mexpr) { HashPtr = mexpr; };
+  inline void SetGrpID(int grpid) { GrpID = grpid; };
+  inline int GetArity() { return (Arity); };
 
   inline void SetNextMExpr(MExression *MExpr) { NextMExpr = MExpr; };
   inline MExression *GetNextMExpr() { return NextMExpr; };
 
+  // Has this rule neither fired on this mexpr nor been masked off for it
+  inline bool can_fire(int rule_no) { return !RuleMask.test(rule_no); };
+
   // We just fired this rule, so update dont_fire bit vector
-  inline void fire_rule(int rule_no) { bit_on(RuleMask, rule_no); };
+  inline void fire_rule(int rule_no) { RuleMask.set(rule_no); };
 
-  inline void set_rule_mask(BIT_VECTOR v) { RuleMask = v; };
+  inline void set_rule_mask(const BIT_VECTOR &v) { RuleMask = v; };
+  // Give a new mexpr the mask of the rule which made it.  It is already in the
+  // search space, so other tasks may be firing rules on it; keep their bits.
+  inline void add_rule_mask(const BIT_VECTOR &v) { RuleMask |= v; };
 
-  ub4 hash() {
-    ub4 hashval = Op->hash();
+  // hash value of the operator and the input groups.  Only for logical mexprs.
+  inline ub4 hash() { return HashVal; };
 
-    // to check the equality of the inputs
-    for (int input_no = Op->GetArity(); --input_no >= 0;) hashval = lookup2(GetInput(input_no), hashval);
+  // Are the operators and arguments, and the input groups the same?  Only for logical mexprs.
+  bool operator==(MExression &other);
 
-    return (hashval % (HtblSize - 1));
-  };
+  // The input group FromGid was merged into ToGid: take ToGid as input instead, and hash again
+  void MergeInput(int FromGid, int ToGid);
 
   string Dump() {
     string os;
@@ -58,7 +76,7 @@ class MExression {
     os = (*Op).Dump();
 
     int Size = GetArity();
-    for (int i = 0; i < Size; i++) os += ", input: " + to_string(children_[i]);
+    for (int i = 0; i < Size; i++) os += ", input: " + to_string(Inputs[i]);
 
     return os;
   };
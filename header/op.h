@@ -10,10 +10,96 @@ class PhysicalOperator;  // Physical Operators on Collections
 class ItemOperator;      // Item Operators on objects, used for predicates
 class LeafOperator;      // Leaf operators - place holder for a group, in a pattern. Patterns are used in rules.
 
+// The operators, one code for each class.  OpTraits lists them in the same order.
+enum class OPCODE : uint8_t {
+  // logical
+  GET,
+  EQJOIN,
+  PROJECT,
+  SELECT,
+  RM_DUPLICATES,
+  AGG_LIST,
+  FUNC_OP,
+  DUMMY,
+  // physical
+  FILE_SCAN,
+  LOOPS_JOIN,
+  PDUMMY,
+  LOOPS_INDEX_JOIN,
+  MERGE_JOIN,
+  HASH_JOIN,
+  P_PROJECT,
+  FILTER,
+  QSORT,
+  HASH_DUPLICATES,
+  HGROUP_LIST,
+  P_FUNC_OP,
+  BIT_JOIN,
+  INDEXED_FILTER,
+  // item
+  ATTR_OP,
+  ATTR_EXP,
+  INT_OP,
+  STR_OP,
+  SET_OP,
+  COMP_OP,
+  // in rules only
+  LEAF,
+  END
+};
+
+enum class OP_KIND : uint8_t { LOGICAL, PHYSICAL, ITEM, LEAF };
+
+struct OP_TRAITS {
+  OPCODE Opcode;
+  const char *Name;  // for dumps only
+  int Arity;         // -1 if it depends on the arguments
+  OP_KIND Kind;
+  int Seed;  // hash value of a logical operator before its arguments and inputs
+};
+
+constexpr OP_TRAITS OpTraits[] = {
+    {OPCODE::GET, "GET", 0, OP_KIND::LOGICAL, 1111},
+    {OPCODE::EQJOIN, "EQJOIN", 2, OP_KIND::LOGICAL, 2222},
+    {OPCODE::PROJECT, "PROJECT", 1, OP_KIND::LOGICAL, 3333},
+    {OPCODE::SELECT, "SELECT", 2, OP_KIND::LOGICAL, 4444},  // an input and a predicate
+    {OPCODE::RM_DUPLICATES, "RM_DUPLICATES", 1, OP_KIND::LOGICAL, 5555},
+    {OPCODE::AGG_LIST, "AGG_LIST", 1, OP_KIND::LOGICAL, 6666},
+    {OPCODE::FUNC_OP, "FUNC_OP", 1, OP_KIND::LOGICAL, 7777},
+    {OPCODE::DUMMY, "DUMMY", 2, OP_KIND::LOGICAL, 8888},
+    {OPCODE::FILE_SCAN, "FILE_SCAN", 0, OP_KIND::PHYSICAL, 0},
+    {OPCODE::LOOPS_JOIN, "LOOPS_JOIN", 2, OP_KIND::PHYSICAL, 0},
+    {OPCODE::PDUMMY, "PDUMMY", 2, OP_KIND::PHYSICAL, 0},
+    {OPCODE::LOOPS_INDEX_JOIN, "LOOPS_INDEX_JOIN", 1, OP_KIND::PHYSICAL, 0},
+    {OPCODE::MERGE_JOIN, "MERGE_JOIN", 2, OP_KIND::PHYSICAL, 0},
+    {OPCODE::HASH_JOIN, "HASH_JOIN", 2, OP_KIND::PHYSICAL, 0},
+    {OPCODE::P_PROJECT, "P_PROJECT", 1, OP_KIND::PHYSICAL, 0},
+    {OPCODE::FILTER, "FILTER", 2, OP_KIND::PHYSICAL, 0},
+    {OPCODE::QSORT, "QSORT", 1, OP_KIND::PHYSICAL, 0},
+    {OPCODE::HASH_DUPLICATES, "HASH_DUPLICATES", 1, OP_KIND::PHYSICAL, 0},
+    {OPCODE::HGROUP_LIST, "HGROUP_LIST", 1, OP_KIND::PHYSICAL, 0},
+    {OPCODE::P_FUNC_OP, "P_FUNC_OP", 1, OP_KIND::PHYSICAL, 0},
+    {OPCODE::BIT_JOIN, "BIT_JOIN", 2, OP_KIND::PHYSICAL, 0},
+    {OPCODE::INDEXED_FILTER, "INDEXED_FILTER", 1, OP_KIND::PHYSICAL, 0},
+    {OPCODE::ATTR_OP, "ATTR_OP", 0, OP_KIND::ITEM, 0},
+    {OPCODE::ATTR_EXP, "ATTR_EXP", 0, OP_KIND::ITEM, 0},
+    {OPCODE::INT_OP, "INT_OP", 0, OP_KIND::ITEM, 0},
+    {OPCODE::STR_OP, "STR_OP", 0, OP_KIND::ITEM, 0},
+    {OPCODE::SET_OP, "SET_OP", 0, OP_KIND::ITEM, 0},
+    {OPCODE::COMP_OP, "COMP_OP", -1, OP_KIND::ITEM, 0},  // OP_NOT has one input, the others two
+    {OPCODE::LEAF, "LeafOperator", 0, OP_KIND::LEAF, 0},
+};
+
+constexpr bool OpTraitsInOrder() {
+  for (int i = 0; i < (int)OPCODE::END; i++)
+    if ((int)OpTraits[i].Opcode != i) return false;
+  return true;
+}
+static_assert(sizeof(OpTraits) / sizeof(OP_TRAITS) == (int)OPCODE::END && OpTraitsInOrder(),
+              "OpTraits must list the OPCODEs in order");
+
 class Operator {
  public:
-  string name;  // Name of this operator
-
   Operator(){};
 
   // add assert to the following virtual functions, make sure the subclasses define them
@@ -21,33 +107,38 @@ class Operator {
 
   virtual ~Operator(){};
 
+  // operators of bindings and substitutes come from the scratch arena of the task
+  static void *operator new(size_t size) { return ScratchAlloc(size); };
+  static void operator delete(void *p, size_t size) { ScratchFree(p, size); };
+
   virtual string Dump() = 0;
   virtual LOG_PROP *FindLogProp(LOG_PROP **input) = 0;
 
   // For example, the operator SELECT has arity 2 (one bulk input, one predicate) and
-  // its name is SELECT.  These are not stored as member data since static does not
-  // inherit and we don't want one in every object.
-  virtual string GetName() = 0;
-  virtual int GetNameId() = 0;
-  virtual int GetArity() = 0;
+  // its name is SELECT.  These come from OpTraits by the opcode of the class, since
+  // static does not inherit and we don't want them in every object.
+  virtual OPCODE GetOpcode() = 0;
+  inline const OP_TRAITS &GetTraits() { return OpTraits[(int)GetOpcode()]; };
+  inline string GetName() { return GetTraits().Name; };
+  virtual int GetArity() { return GetTraits().Arity; };
 
-  virtual bool operator==(Operator *other) { return (GetNameId() == other->GetNameId()); };
+  virtual bool operator==(Operator *other) { return (GetOpcode() == other->GetOpcode()); };
 
   // Used to compute the hash value of an mexpr.  Used only for logical operators,
   // so we make it abort everywhere else.
   virtual ub4 hash() = 0;
 
-  virtual bool is_logical() { return false; };
-  virtual bool is_physical() { return false; };
-  virtual bool is_leaf() { return false; };
-  virtual bool is_item() { return false; };
+  inline bool is_logical() { return GetTraits().Kind == OP_KIND::LOGICAL; };
+  inline bool is_physical() { return GetTraits().Kind == OP_KIND::PHYSICAL; };
+  inline bool is_leaf() { return GetTraits().Kind == OP_KIND::LEAF; };
+  inline bool is_item() { return GetTraits().Kind == OP_KIND::ITEM; };
 
   // attr_op, const_int_op, const_set_op, const_str_op are special case in O_INPUT::perform()
   virtual bool is_const() { return false; };
 
   // 计算表达式的代价
   // 逻辑表达式没有代价，物理表达式才计算代价
-  virtual Cost *FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) = 0;
+  virtual Cost FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) = 0;
 };
 
 // Logical Operator Abstract Class
@@ -62,19 +153,17 @@ class LogicalOperator : public Operator {
   // This should be moved to the Operator class if we ever apply rules to
   // other than logical operators.
   // If someone writes a rule which uses member data, it could be made virtual
-  inline bool OpMatch(LogicalOperator *other) { return (GetNameId() == other->GetNameId()); };
+  inline bool OpMatch(LogicalOperator *other) { return (GetOpcode() == other->GetOpcode()); };
 
-  inline bool is_logical() { return true; };
-
-  inline ub4 GetInitval() { return (lookup2(GetNameId(), 0)); };
+  inline ub4 GetInitval() { return (lookup2(GetTraits().Seed, 0)); };
   // Get the initial value for hashing, which depends
   // only on the name of the operator.
 
   // add assert to the following functions,
   // make sure these methods of LogicalOperator never called(log_op does not get cost)
-  Cost *FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) {
+  Cost FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) {
     assert(false);
-    return nullptr;
+    return Cost::Infinite();
   };
 };
 
@@ -94,7 +183,7 @@ class PhysicalOperator : public Operator {
   // FindLocalCost() finds the local cost of the operator,
   // including output but not input costs.  Thus we compute output costs
   // only once, and get input costs from (as part of) the input operators' cost.
-  virtual Cost *FindLocalCost(LOG_PROP *LocalLogProp,        // uses primarily the card of the Group
+  virtual Cost FindLocalCost(LOG_PROP *LocalLogProp,        // uses primarily the card of the Group
                               LOG_PROP **InputLogProp) = 0;  // uses primarily cardinalities
 
   /*  Some algorithms and implementation rules require that
@@ -112,17 +201,12 @@ virtual int opt_combs() */
   // Should never be called for arity 0 operators
   virtual PHYS_PROP *InputReqdProp(PHYS_PROP *PhysProp, LOG_PROP *InputLogProp, int InputNo, bool &possible) = 0;
 
-  inline bool is_physical() { return true; };
   // add assert to the following functions,
   // make sure these methods of PhysicalOperator never called(log_prop is not passed by phys_op)
   LOG_PROP *FindLogProp(LOG_PROP **input) {
     assert(false);
     return nullptr;
   };
-  inline int GetNameId() {
-    assert(false);
-    return 0;
-  };
   ub4 hash() {
     assert(false);
     return 0;
@@ -143,21 +227,15 @@ class ItemOperator : public Operator {
   ~ItemOperator(){};
 
   // For now we assume no expensive predicates
-  Cost *FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) { return (new Cost(0)); };
+  Cost FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) { return Cost(0); };
 
   LOG_PROP *FindLogProp(LOG_PROP **input) {
     KEYS_SET empty_arr;
     return (new LOG_ITEM_PROP(-1, -1, -1, 0, empty_arr));
   }
 
-  inline bool is_item() { return true; };
-
   // add assert to the following functions,
   // make sure these methods of ItemOperator never called
-  inline int GetNameId() {
-    assert(false);
-    return 0;
-  };
   ub4 hash() {
     assert(false);
     return 0;
@@ -173,41 +251,30 @@ class LeafOperator : public Operator {
   int Index;  // Used to distinguish this leaf in a rule
 
  public:
-  LeafOperator(int index, int group = -1) : Index(index), Group(group) {
-    name = GetName();  // for debug
-  };
+  LeafOperator(int index, int group = -1) : Index(index), Group(group){};
 
-  LeafOperator(LeafOperator &Op) : Index(Op.Index), Group(Op.Group) {
-    name = Op.name;  // for debug
-  };
+  LeafOperator(LeafOperator &Op) : Index(Op.Index), Group(Op.Group){};
 
   inline Operator *Clone() { return new LeafOperator(*this); };
 
   ~LeafOperator(){};
 
-  inline int GetArity() { return (0); };
-  inline string GetName() { return ("LeafOperator"); };
+  inline OPCODE GetOpcode() { return OPCODE::LEAF; };
   inline int GetGroup() { return (Group); };
   inline int GetIndex() { return (Index); };
 
-  inline bool is_leaf() { return true; };
-
   string Dump() { return GetName() + "<" + to_string(Index) + "," + to_string(Group) + ">"; };
 
   // add assert to the following functions,
   // make sure these methods of LeafOperator never called
-  inline int GetNameId() {
-    assert(false);
-    return 0;
-  };
   ub4 hash() {
     assert(false);
     return 0;
   };
 
-  Cost *FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) {
+  Cost FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp) {
     assert(false);
-    return nullptr;
+    return Cost::Infinite();
   };
 
   LOG_PROP *FindLogProp(LOG_PROP **input) {
@@ -24,12 +24,11 @@ class FILE_SCAN : public PhysicalOperator {
 
   ~FILE_SCAN(){};
 
-  Cost *FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp);
+  Cost FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp);
 
   PHYS_PROP *FindPhysProp(PHYS_PROP **input_phys_props = nullptr);
 
-  inline string GetName() { return ("FILE_SCAN"); };
-  inline int GetArity() { return (0); };
+  inline OPCODE GetOpcode() { return OPCODE::FILE_SCAN; };
   inline int GetFileId() { return FileId; };
 
   string Dump() { return GetName() + "(" + GetCollName(FileId) + ")"; };
@@ -63,11 +62,10 @@ class LOOPS_JOIN : public PhysicalOperator {
     delete[] rattrs;
   };
 
-  Cost *FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp);
+  Cost FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp);
 
   PHYS_PROP *InputReqdProp(PHYS_PROP *PhysProp, LOG_PROP *InputLogProp, int InputNo, bool &possible);
-  inline int GetArity() { return (2); };
-  inline string GetName() { return ("LOOPS_JOIN"); };
+  inline OPCODE GetOpcode() { return OPCODE::LOOPS_JOIN; };
 
   string Dump();
 };
@@ -82,11 +80,10 @@ class PDUMMY : public PhysicalOperator {
 
   ~PDUMMY(){};
 
-  Cost *FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp);
+  Cost FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp);
 
   PHYS_PROP *InputReqdProp(PHYS_PROP *PhysProp, LOG_PROP *InputLogProp, int InputNo, bool &possible);
-  inline int GetArity() { return (2); };
-  inline string GetName() { return ("PDUMMY"); };
+  inline OPCODE GetOpcode() { return OPCODE::PDUMMY; };
 
   string Dump();
 };
@@ -114,13 +111,12 @@ class LOOPS_INDEX_JOIN : public PhysicalOperator {
     delete[] rattrs;
   };
 
-  Cost *FindLocalCost(LOG_PROP *LocalLogProp,    // uses primarily the card of the Group
+  Cost FindLocalCost(LOG_PROP *LocalLogProp,    // uses primarily the card of the Group
                       LOG_PROP **InputLogProp);  // uses primarily cardinalities
 
   PHYS_PROP *InputReqdProp(PHYS_PROP *PhysProp, LOG_PROP *InputLogProp, int InputNo, bool &possible);
 
-  inline int GetArity() { return (1); };
-  inline string GetName() { return ("LOOPS_INDEX_JOIN"); };
+  inline OPCODE GetOpcode() { return OPCODE::LOOPS_INDEX_JOIN; };
 
   string Dump();
 };  // LOOPS_INDEX_JOIN
@@ -158,16 +154,14 @@ class MERGE_JOIN : public PhysicalOperator {
   };
 
   //##ModelId=3B0C086F0167
-  Cost *FindLocalCost(LOG_PROP *LocalLogProp,    // uses primarily the card of the Group
+  Cost FindLocalCost(LOG_PROP *LocalLogProp,    // uses primarily the card of the Group
                       LOG_PROP **InputLogProp);  // uses primarily cardinalities
 
   //##ModelId=3B0C086F0171
   PHYS_PROP *InputReqdProp(PHYS_PROP *PhysProp, LOG_PROP *InputLogProp, int InputNo, bool &possible);
 
-  //##ModelId=3B0C086F0185
-  inline int GetArity() { return (2); };
   //##ModelId=3B0C086F0186
-  inline string GetName() { return ("MERGE_JOIN"); };
+  inline OPCODE GetOpcode() { return OPCODE::MERGE_JOIN; };
   //##ModelId=3B0C086F018F
   PHYS_PROP *FindPhysProp(PHYS_PROP **input_phys_props);
   //##ModelId=3B0C086F0199
@@ -197,16 +191,14 @@ class HASH_JOIN : public PhysicalOperator {
   };
 
   //##ModelId=3B0C086F0261
-  Cost *FindLocalCost(LOG_PROP *LocalLogProp,    // uses primarily the card of the Group
+  Cost FindLocalCost(LOG_PROP *LocalLogProp,    // uses primarily the card of the Group
                       LOG_PROP **InputLogProp);  // uses primarily cardinalities
 
   //##ModelId=3B0C086F026B
   PHYS_PROP *InputReqdProp(PHYS_PROP *PhysProp, LOG_PROP *InputLogProp, int InputNo, bool &possible);
 
-  //##ModelId=3B0C086F0278
-  inline int GetArity() { return (2); };
   //##ModelId=3B0C086F0280
-  inline string GetName() { return ("HASH_JOIN"); };
+  inline OPCODE GetOpcode() { return OPCODE::HASH_JOIN; };
   //##ModelId=3B0C086F028A
   string Dump();
 
@@ -232,16 +224,14 @@ class P_PROJECT : public PhysicalOperator {
   ~P_PROJECT() { delete[] attrs; };
 
   //##ModelId=3B0C086F0367
-  Cost *FindLocalCost(LOG_PROP *LocalLogProp,    // uses primarily the card of the Group
+  Cost FindLocalCost(LOG_PROP *LocalLogProp,    // uses primarily the card of the Group
                       LOG_PROP **InputLogProp);  // uses primarily cardinalities
 
   //##ModelId=3B0C086F0372
   PHYS_PROP *InputReqdProp(PHYS_PROP *PhysProp, LOG_PROP *InputLogProp, int InputNo, bool &possible);
 
-  //##ModelId=3B0C086F0384
-  inline int GetArity() { return (1); };
   //##ModelId=3B0C086F038E
-  inline string GetName() { return ("P_PROJECT"); };
+  inline OPCODE GetOpcode() { return OPCODE::P_PROJECT; };
 
   //##ModelId=3B0C086F038F
   string Dump();
@@ -267,16 +257,14 @@ class FILTER : public PhysicalOperator {
   inline Operator *Clone() { return new FILTER(*this); };
 
   //##ModelId=3B0C08700050
-  Cost *FindLocalCost(LOG_PROP *LocalLogProp,    // uses primarily the card of the Group
+  Cost FindLocalCost(LOG_PROP *LocalLogProp,    // uses primarily the card of the Group
                       LOG_PROP **InputLogProp);  // uses primarily cardinalities
 
   //##ModelId=3B0C0870005C
   PHYS_PROP *InputReqdProp(PHYS_PROP *PhysProp, LOG_PROP *InputLogProp, int InputNo, bool &possible);
 
-  //##ModelId=3B0C0870006E
-  inline int GetArity() { return (2); };
   //##ModelId=3B0C08700078
-  inline string GetName() { return ("FILTER"); };
+  inline OPCODE GetOpcode() { return OPCODE::FILTER; };
 
   //##ModelId=3B0C08700079
   string Dump() { return GetName(); };
@@ -298,12 +286,11 @@ class QSORT : public PhysicalOperator {
 
   ~QSORT(){};
 
-  Cost *FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp);
+  Cost FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp);
 
   PHYS_PROP *InputReqdProp(PHYS_PROP *PhysProp, LOG_PROP *InputLogProp, int InputNo, bool &possible);
 
-  inline int GetArity() { return (1); };
-  inline string GetName() { return ("QSORT"); };
+  inline OPCODE GetOpcode() { return OPCODE::QSORT; };
 
   string Dump();
 };  // QSORT
@@ -317,13 +304,12 @@ class HASH_DUPLICATES : public PhysicalOperator {
 
   ~HASH_DUPLICATES(){};
 
-  Cost *FindLocalCost(LOG_PROP *LocalLogProp,    // uses primarily the card of the Group
+  Cost FindLocalCost(LOG_PROP *LocalLogProp,    // uses primarily the card of the Group
                       LOG_PROP **InputLogProp);  // uses primarily cardinalities
 
   PHYS_PROP *InputReqdProp(PHYS_PROP *PhysProp, LOG_PROP *InputLogProp, int InputNo, bool &possible);
 
-  inline int GetArity() { return (1); };
-  inline string GetName() { return ("HASH_DUPLICATES"); };
+  inline OPCODE GetOpcode() { return OPCODE::HASH_DUPLICATES; };
 
   string Dump();
 
@@ -356,13 +342,12 @@ class HGROUP_LIST : public PhysicalOperator {
     delete[] GbyAtts;
   };
 
-  Cost *FindLocalCost(LOG_PROP *LocalLogProp,    // uses primarily the card of the Group
+  Cost FindLocalCost(LOG_PROP *LocalLogProp,    // uses primarily the card of the Group
                       LOG_PROP **InputLogProp);  // uses primarily cardinalities
 
   PHYS_PROP *InputReqdProp(PHYS_PROP *PhysProp, LOG_PROP *InputLogProp, int InputNo, bool &possible);
 
-  inline int GetArity() { return (1); };
-  inline string GetName() { return ("HGROUP_LIST"); };
+  inline OPCODE GetOpcode() { return OPCODE::HGROUP_LIST; };
   PHYS_PROP *FindPhysProp(PHYS_PROP **input_phys_props);
   string Dump();
 
@@ -382,12 +367,11 @@ class P_FUNC_OP : public PhysicalOperator {
 
   ~P_FUNC_OP() { delete[] Atts; };
 
-  Cost *FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp);
+  Cost FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp);
 
   PHYS_PROP *InputReqdProp(PHYS_PROP *PhysProp, LOG_PROP *InputLogProp, int InputNo, bool &possible);
 
-  inline int GetArity() { return (1); };
-  inline string GetName() { return ("P_FUNC_OP"); };
+  inline OPCODE GetOpcode() { return OPCODE::P_FUNC_OP; };
 
   string Dump();
 };
@@ -415,14 +399,13 @@ class BIT_JOIN : public PhysicalOperator {
     delete[] rattrs;
   };
 
-  Cost *FindLocalCost(LOG_PROP *LocalLogProp,    // uses primarily the card of the Group
+  Cost FindLocalCost(LOG_PROP *LocalLogProp,    // uses primarily the card of the Group
                       LOG_PROP **InputLogProp);  // uses primarily cardinalities
 
   PHYS_PROP *InputReqdProp(PHYS_PROP *PhysProp, LOG_PROP *InputLogProp, int InputNo, bool &possible);
   PHYS_PROP *FindPhysProp(PHYS_PROP **input_phys_props);
 
-  inline int GetArity() { return (2); };
-  inline string GetName() { return ("BIT_JOIN"); };
+  inline OPCODE GetOpcode() { return OPCODE::BIT_JOIN; };
 
   string Dump();
 };
@@ -436,12 +419,11 @@ class INDEXED_FILTER : public PhysicalOperator {
 
   inline Operator *Clone() { return new INDEXED_FILTER(*this); };
 
-  Cost *FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp);
+  Cost FindLocalCost(LOG_PROP *LocalLogProp, LOG_PROP **InputLogProp);
 
   PHYS_PROP *InputReqdProp(PHYS_PROP *PhysProp, LOG_PROP *InputLogProp, int InputNo, bool &possible);
 
-  inline int GetArity() { return (1); };
-  inline string GetName() { return ("INDEXED_FILTER"); };
+  inline OPCODE GetOpcode() { return OPCODE::INDEXED_FILTER; };
   inline int GetFileId() { return FileId; };
 
   string Dump() { return GetName() + "(" + GetCollName(FileId) + ")"; };
@@ -25,35 +25,6 @@ class AGG_THRU_EQJOIN;
 class SELECT_TO_INDEXED_FILTER;
 class DUMMY_TO_PDUMMY;
 
-/*
-This enum list is used for the rule bit vector.  It must be consistent with NUMOFRULES
-and rule_set and with the rule set file read from disk. If there are more than 32 rules,
-put only logical to logical transformations in the rule vector.
-*/
-typedef enum RULELABELS {
-  R_GET_TO_FILE_SCAN,
-  R_SELECT_TO_FILTER,
-  R_P_TO_PP,
-  R_EQ_TO_LOOPS_INDEX,
-  R_EQ_TO_MERGE,
-  R_EQ_TO_LOOPS,
-  R_SORT_RULE,
-  R_EQJOIN_COMMUTE,
-  R_EQJOIN_LTOR,
-  R_EQJOIN_RTOL,
-  R_EXCHANGE,
-  R_RM_TO_HASH_DUPLICATES,
-  R_AL_TO_HGL,
-  R_FO_TO_PFO,
-  R_AGG_THRU_EQJOIN,
-  R_EQ_TO_BIT,
-  R_SELECT_TO_INDEXED_FILTER,
-  R_PROJECT_THRU_SELECT,
-  R_EQ_TO_HASH,
-  R_DUMMY_TO_PDUMMY,
-  R_END,
-} RULELABELS;
-
 enum class RuleType : uint32_t {
   // Transformation rules (logical -> logical)
   INNER_JOIN_COMMUTE = 0,
@@ -124,10 +95,22 @@ enum class RuleType : uint32_t {
   NUM_RULES
 };
 
+// The rules which may match an operator, in rule number order
+struct RULE_LIST {
+  vector<Rule *> Explore;    // transformation rules
+  vector<Rule *> Implement;  // implementation rules
+};
+
 class RuleSet {
  private:
   vector<Rule *> rule_set;
 
+  // Rules indexed by the root operator of their original pattern, so
+  // OptimizeExprTask does not call top_match() on every rule.  Rules rooted
+  // at a leaf (enforcers) match any operator and are in every list.
+  RULE_LIST ByOp[(int)OPCODE::END];
+  void Index();
+
  public:
   int RuleCount;  // size of rule_set
 
@@ -139,6 +122,9 @@ class RuleSet {
 
   // return the Rule in the order Set
   inline Rule *operator[](int n) { return rule_set[n]; }
+
+  // the rules whose original pattern may match a logical operator
+  inline RULE_LIST &Candidates(Operator *op_arg) { return ByOp[(int)op_arg->GetOpcode()]; }
 };
 
 /*
@@ -218,6 +204,9 @@ class BINDERY {
 
   ~BINDERY();
 
+  static void *operator new(size_t size) { return ScratchAlloc(size); };
+  static void operator delete(void *p, size_t size) { ScratchFree(p, size); };
+
   // advance() requests a bindery to produce its next binding, if one
   // exists.  This may cause the state of the bindery to change.
   // advance() returns true if a binding has been found.
@@ -257,9 +246,9 @@ class BINDERY {
       pattern are logical except perhaps the root operator.
 
   In OptimizeExprTask::perform(), the optimizer decides which rules to push onto
-  the PTASK stack.  It uses top_match() to check whether the root operator
-  of the original pattern of a rule matches the root operator of the
-      current multiexpression.
+  the PTASK stack.  It takes the rules whose original pattern has the root
+  operator of the current multiexpression, as top_match() would, from the
+  index of RuleSet::Candidates(), and drops those masked off in its RuleMask.
 
   The method OptimizeExprTask::perform() must decide the order in which rules
   are pushed onto the PTASK stack.  For this purpose it uses promise().
@@ -319,7 +308,7 @@ class Rule {
 
  public:
   Rule(string name, int arity, Expression *original, Expression *substitute)
-      : name(name), arity(arity), mask(0), original(original), substitute(substitute){};
+      : name(name), arity(arity), original(original), substitute(substitute){};
 
   virtual ~Rule() {
     delete original;
@@ -358,10 +347,10 @@ class Rule {
   bool check();  // check that original & subst. patterns are legal
 
   inline int get_index() { return (index); };       // get the rule's index in the rule set
-  inline BIT_VECTOR get_mask() { return (mask); };  // get the rule's mask
+  inline BIT_VECTOR &get_mask() { return (mask); };  // get the rule's mask
 
   inline void set_index(int i) { index = i; };
-  inline void set_mask(BIT_VECTOR v) { mask = v; };
+  inline void set_mask(const BIT_VECTOR &v) { mask = v; };
 
   string Dump() { return "rule : " + name; };
 
@@ -421,6 +410,14 @@ class EQ_TO_LOOPS_INDEX : public Rule {
 ============================================================
 EQJOIN Commutativity Rule
 ============================================================
+EQJOIN_COMMUTE, EQJOIN_LTOR, EQJOIN_RTOL and EXCHANGE are the rule set
+RS-B2 (see JOIN_RULE_SET): the substitute of EQJOIN_COMMUTE or EXCHANGE
+gets none of the four, and that of EQJOIN_LTOR or EQJOIN_RTOL only
+EQJOIN_COMMUTE.  The new lower joins get all of them.  Every bushy join
+order, Cartesian products included, is then made exactly once.  The
+conditions of EQJOIN_LTOR, EQJOIN_RTOL and EXCHANGE drop the substitutes
+with Cartesian products the policy Cartesian does not allow; under
+CART_FORBID the rules still make every order without them.
 */
 //##ModelId=3B0C086A03C3
 class EQJOIN_COMMUTE : public Rule {
@@ -7,10 +7,74 @@
 
 #define NEW_GRPID_NOWIN -2  // use by SearchSpace::CopyIn.  Means NEW_GRPID, and this is a
 // subgroup of DUMMY so don't init nontrivial winners
+#define SHARD_BITS 8                   // LOG2 of the number of shards of the duplicate table
+#define HASH_SHARDS (1 << SHARD_BITS)  // number of shards, each with its own lock
+#define SHARD_INIT_SIZE 32             // initial number of slots in a shard, a power of 2
+#define SEED_SLACK 1e-6                // the bound of a seeded search exceeds the cost of its seed plan by this
+                                       // fraction, so rounding cannot prune the seed plan itself
 class SearchSpace;
 class Group;
 class WINNER;
 
+/*
+============================================================
+DUPLICATE TABLE - class MEXPR_TABLE
+============================================================
+Hash table of the logical mexprs in the search space, used to find
+duplicates.  The table uses open addressing: each slot holds an mexpr and
+its hash, so a probe reads consecutive slots and compares two mexprs only
+when their whole hashes are equal.
+
+Collisions are resolved by Robin Hood linear probing.  An entry which is
+further from its home slot than the one in its way takes that slot and the
+displaced entry moves on, so probe sequences stay short and a lookup can
+stop as soon as it passes entries closer to their home than it is.  Removal
+shifts the following entries back, so there are no tombstones.
+
+The table is split into HASH_SHARDS shards by the low bits of the hash.  A
+shard has its own lock and doubles its slots when it becomes 7/8 full, so
+workers inserting into other shards never wait for a lookup or a resize.
+*/
+class MEXPR_TABLE {
+ private:
+  struct SLOT {
+    ub4 Hash;
+    MExression *MExpr;  // nullptr if the slot is empty
+  };
+
+  struct SHARD {
+    mutex Lock;
+    SLOT *Slots;
+    int Mask;   // number of slots - 1
+    int Count;  // number of mexprs
+  };
+
+  SHARD Shards[HASH_SHARDS];
+
+  inline SHARD &GetShard(ub4 Hash) { return Shards[Hash & (HASH_SHARDS - 1)]; };
+  // slot where an entry with this hash belongs
+  inline int Home(ub4 Hash, int Mask) { return (Hash >> SHARD_BITS) & Mask; };
+  // how far the entry in slot i is from its home
+  inline int Distance(ub4 Hash, int i, int Mask) { return (i - Home(Hash, Mask)) & Mask; };
+
+  void Place(SHARD &Shard, SLOT Entry);
+  void Grow(SHARD &Shard);
+
+ public:
+  MEXPR_TABLE();
+  ~MEXPR_TABLE();
+
+  // If an mexpr identical to MExpr is in the table, return it, else insert MExpr and return nullptr
+  MExression *FindOrInsert(MExression &MExpr);
+  // remove MExpr from the table, return false if it was not there
+  bool Remove(MExression *MExpr);
+
+  int size();      // number of mexprs
+  int capacity();  // number of slots
+
+  string Dump();
+};
+
 /*
 ============================================================
 SEARCH SPACE - class SearchSpace
@@ -39,7 +103,8 @@ more detail by an expression (class Expression).
 // Search Space
 class SearchSpace {
  public:
-  MExression **HashTbl;  // To identify duplicate MExprs
+  MEXPR_TABLE HashTbl;  // To identify duplicate MExprs
+  LOG_PROP_TABLE LogProps;  // logical properties of the groups
 
   SearchSpace();
 
@@ -48,13 +113,21 @@ class SearchSpace {
 
   ~SearchSpace();
 
-  void optimize();  // Later add a conditon.  Prepare the SearchSpace so an optimal plan can be found
+  // Find an optimal plan for the root, among those costing less than UpperBd
+  void optimize(const Cost &UpperBd = Cost::Infinite());
+
+  // Anytime mode.  Once DeadlineMs have passed since optimize() began, no
+  // more transformation rules are fired and no group is explored.  The
+  // logical expressions found so far are still implemented and costed, so
+  // the root gets the cheapest plan among them.
+  bool PastDeadline();
 
   // Convert the Expression into a Mexpr.
   // If Mexpr is not already in the search space, then copy Mexpr into the
   // search space and return the new Mexpr.
-  // If Mexpr is already in the search space, then either throw it away or
-  // merge groups.
+  // If Mexpr is already in the search space, then either throw it away and
+  // return nullptr or, when it is in another group than GrpID, queue the merge
+  // of the two groups and return the Mexpr found in the other group.
   // GrpID is the ID of the group where Mexpr will be put.  If GrpID is
   // NEW_GRPID(-1), make a new group with that ID and return its value in GrpID.
   MExression *CopyIn(Expression *Expr, int &GrpID);
@@ -68,24 +141,40 @@ class SearchSpace {
   // return the ID of the Root group
   inline int GetRootGID() { return (RootGID); };
 
-  // return the specific group
-  inline Group *GetGroup(int Gid) { return Groups[Gid]; };
+  // return the specific group, or the group it was merged into.  A worker may
+  // have given the group's first mexpr to the hash table and still be creating
+  // the group; wait for it.
+  inline Group *GetGroup(int Gid) {
+    Group *group;
+    while (!(group = Groups[Gid])) this_thread::yield();
+    return group;
+  };
 
   // If another expression in the search space is identical to MExpr, return
-  //  it, else return nullptr.
+  //  it, else insert MExpr into the hash table and return nullptr.
   //  Identical means operators and arguments, and input groups are the same.
   MExression *FindDup(MExression &MExpr);
 
   // When a duplicate is found in two groups they should be merged into
   //  the same group.  We always merge bigger group_no group to smaller one.
+  //  Tasks hold pointers to groups and mexprs, so groups are merged only while
+  //  no task is performing: CopyIn queues the merge, and the TaskScheduler
+  //  calls MergeQueued() once every worker is between tasks.
   int MergeGroups(int group_no1, int group_no2);
-  // int MergeGroups(Group & ToGroup, Group & FromGroup);
+  void QueueMerge(int group_no1, int group_no2);
+  inline bool MergesQueued() { return QueuedMerges > 0; };
+  void MergeQueued();
 
   void ShrinkGroup(int group_no);  // shrink the group marked completed
   void Shrink();                   // shrink the ssp
 
   bool IsChanged();  // is the ssp changed?
 
+  // Memory for the mexprs, winners and circle entries.  Each worker has an
+  // arena of its own, so allocating takes no lock; all of them are released
+  // with the search space.
+  ARENA &GetArena();
+
   string Dump();
   void FastDump();
 
@@ -95,10 +184,25 @@ class SearchSpace {
  private:
   int RootGID;       // ID of the oldest, root group.  Set to NEW_GRPID in SearchSpace""Init then never changes
   int InitGroupNum;  //(seems to be the same as RootGID)
-  int NewGrpID;      // ID of the newest group, initially -1
+  atomic<int> NewGrpID;  // ID of the newest group, initially -1
+
+  // Collection of Groups, indexed by int.  An ID given back after finding a
+  // duplicate may be left as a hole when another worker took a newer one.
+  // The ID of a merged group indexes the group it was merged into.
+  SHARED_ARRAY<Group> Groups;
+  vector<Group *> MergedGroups;  // kept for the tasks still pointing to them, deleted with the search space
+  vector<MExression *> DroppedMExprs;  // likewise, duplicates dropped from their groups
+
+  // pairs of equivalent groups found by CopyIn, not merged yet
+  mutex MergeLock;
+  vector<pair<int, int>> Merges;
+  atomic<int> QueuedMerges;
 
-  // Collection of Groups, indexed by int
-  vector<Group *> Groups;
+  vector<ARENA *> Arenas;  // indexed by worker
+
+  chrono::steady_clock::time_point Deadline;
+  atomic<bool> Expired;  // the deadline has passed
+  int ExpiredTask;       // the number of the task which found it passed
 
 };  // class SearchSpace
 
@@ -135,14 +239,16 @@ And any of these imply:
 The truth of the above assumptions depend on whether we fire all
 applicable rules when the property is ANY. */
 
+// Tasks read the state without locking, so each bit is an atomic of its own
 struct BIT_STATE {
-  unsigned changed : 1;  // has the group got changed or just created?
+  atomic<bool> changed;  // has the group got changed or just created?
   // Used for tracing
-  unsigned exploring : 1;   // is the group being explored?
-  unsigned explored : 1;    // Has the group been explored?
-  unsigned optimizing : 1;  // is the group being optimized?
-  unsigned optimized : 1;   // has the group been optimized (completed) ?
-  unsigned others : 1;
+  atomic<bool> exploring;   // is the group being explored?
+  atomic<bool> explored;    // Has the group been explored?
+  atomic<bool> optimizing;  // is the group being optimized?
+  atomic<bool> optimized;   // has the group been optimized (completed) ?
+  atomic<bool> enumerated;  // have its join orders been copied in by a JoinEnumerator?
+  atomic<bool> others;
 };
 
 class Group {
@@ -159,26 +265,51 @@ class Group {
   inline void SetLastPhysMExpr(MExression *last) { LastPhysMExpr = last; };
 
   // Manipulate states
-  inline void init_state() { State.changed = State.explored = State.exploring = State.optimized = false; }
+  inline void init_state() {
+    State.changed = State.explored = State.exploring = State.optimized = State.enumerated = false;
+  }
   inline bool is_explored() { return (State.explored); }
   inline void set_explored(bool is_explored) { State.explored = is_explored; }
   inline bool is_changed() { return (State.changed); }
   inline void set_changed(bool is_changed) { State.changed = is_changed; }
   inline bool is_optimized() { return (State.optimized); }
   void set_optimized(bool is_optimized);
+  inline bool is_enumerated() { return (State.enumerated); }
+  inline void set_enumerated(bool is_enumerated) { State.enumerated = is_enumerated; }
   inline bool is_exploring() { return (State.exploring); }
   inline void set_exploring(bool is_exploring) { State.exploring = is_exploring; }
+  // tasks waiting for the exploration in progress to finish, guarded by GetLock()
+  inline vector<OptimizerTask *> &GetExploreWaiters() { return ExploreWaiters; };
+
+  // Held by a task while it looks at the state and the winner's circle and
+  // decides to begin a search, wait for one, or finish one.
+  inline recursive_mutex &GetLock() { return Lock; };
 
   // Get's
   inline LOG_PROP *get_log_prop() { return LogProp; };
-  inline Cost *GetLowerBd() { return LowerBd; };
+  inline Cost GetLowerBd() { return LowerBd; };
   inline double GetEstiGrpSize() { return EstiGrpSize; };
   inline int GetCount() { return count; };
   inline int GetGroupID() { return (GroupID); };
+  // IDs of the groups merged into this one
+  inline vector<int> &GetMergedIDs() { return MergedIDs; };
 
-  // Add a new MExpr to the group
+  // Add a new MExpr to the group.  Tasks walking the group's lists see it
+  // once it is linked in.
   void NewMExpr(MExression *MExpr);
 
+  // Logical mexprs with this group as an input, whose hash changes if the group is merged
+  void NewParent(MExression *MExpr);
+  inline vector<MExression *> &GetParents() { return Parents; };
+
+  // Unlink a logical MExpr found to duplicate another one of the group.
+  // Only called while no task is performing; tasks may still hold MExpr.
+  void DropLogMExpr(MExression *MExpr);
+
+  // Take over the mexprs, winners and waiters of From, an equivalent group.
+  // Only called while no task is performing.  Tasks to wake up are added to Woken.
+  void Merge(Group *From, vector<OptimizerTask *> &Woken);
+
   /*search_circle returns the state of the winner's circle for this
   context and group - it does no rule firing.  Thus it is cheap to execute.
     search_circle returns in four possible states:
@@ -203,14 +334,28 @@ class Group {
 
   */
   bool search_circle(CONT *C, bool &moresearch);
+  // Also return the winner, if any, which search_circle looked at
+  bool search_circle(CONT *C, bool &moresearch, WINNER *&Winner);
 
   // Manipulate Winner's circle
+  // A winner never changes once it is in the circle, so tasks read winners
+  // without locking.  The winner for a property is replaced by a new one.
+
   // Return winner for this property, nullptr if there is none
   WINNER *GetWinner(PHYS_PROP *PhysProp);
-  // If there is a winner for ReqdProp, error.
-  // Create a new winner for the property ReqdProp, with these parameters.
-  // Used when beginning the first search for ReqdProp.
-  void NewWinner(PHYS_PROP *ReqdProp, MExression *MExpr, Cost *TotalCost, bool done);
+  // Create a new winner for the property ReqdProp, with these parameters,
+  // replacing the current one if any.
+  // Used when beginning a search for ReqdProp.
+  void NewWinner(PHYS_PROP *ReqdProp, MExression *MExpr, const Cost &TotalCost, bool done);
+  // If TotalCost beats the winner for ReqdProp, make MExpr the winner (not
+  // done) and return true.  Tasks of the search race to do this; the winner
+  // is replaced with compare and swap, so the cheapest plan wins.
+  bool ImproveWinner(PHYS_PROP *ReqdProp, MExression *MExpr, const Cost &TotalCost);
+  // Mark the winner for ReqdProp done, when its search is complete, or not
+  // done, when a new search for ReqdProp begins.
+  void SetWinnerDone(PHYS_PROP *ReqdProp, bool done);
+  // tasks waiting for the search for ReqdProp to complete, guarded by GetLock()
+  vector<OptimizerTask *> &GetWaiters(PHYS_PROP *ReqdProp);
 
   void ShrinkSubGroup();
 
@@ -218,34 +363,59 @@ class Group {
 
   bool CheckWinnerDone();  // check if there is at least one winner done in this group
 
-  void setfirstplan(bool boolean) { firstplan = boolean; };
+  // return the previous value
+  bool setfirstplan(bool boolean) { return firstplan.exchange(boolean); };
   bool getfirstplan() { return firstplan; };
 
  private:
   int GroupID;  // ID of this group
 
-  MExression *FirstLogMExpr;   // first log MExression in  the Group
-  MExression *LastLogMExpr;    // last log MExression in  the Group
-  MExression *FirstPhysMExpr;  // first phys MExression in  the Group
-  MExression *LastPhysMExpr;   // last phys MExression in  the Group
+  MExression *FirstLogMExpr;            // first log MExression in  the Group
+  MExression *LastLogMExpr;             // last log MExression in  the Group
+  atomic<MExression *> FirstPhysMExpr;  // first phys MExression in  the Group
+  MExression *LastPhysMExpr;            // last phys MExression in  the Group
 
   struct BIT_STATE State;  //  the state of the group
 
   LOG_PROP *LogProp;  // Logical properties of this Group
-  Cost *LowerBd;      // lower bound of cost of fetching cucard tuples from disc
+  Cost LowerBd;       // lower bound of cost of fetching cucard tuples from disc
+
+  // Winner's circle: an entry for each property the group has been searched
+  // for, holding the current winner and the tasks waiting for the search.
+  // Entries are only added, under Lock.  A group is searched for few
+  // properties, so the entries are a list found by the id of the property.
+  struct CIRCLE_ENTRY {
+    int PropId;
+    PHYS_PROP *PhysProp;  // the canonical instance of the property, its winners point to it
+    atomic<WINNER *> Winner;
+    vector<OptimizerTask *> Waiters;
+    atomic<CIRCLE_ENTRY *> Next;
+
+    static void *operator new(size_t size);
+    static void operator delete(void *p, size_t size);
+  };
+  atomic<CIRCLE_ENTRY *> FirstEntry;
+  CIRCLE_ENTRY *LastEntry;
 
-  // Winner's circle
-  vector<WINNER *> Winners;
+  CIRCLE_ENTRY *GetEntry(int PropId);
+
+  vector<OptimizerTask *> ExploreWaiters;
+
+  vector<MExression *> Parents;  // guarded by Lock
+  vector<int> MergedIDs;
+
+  // guards the lists' tails, the circle's entries and the waiters
+  recursive_mutex Lock;
 
   // if operator is EQJOIN, estimate the group size, else estimate group size =0
   // used for halt option
   double EstiGrpSize;
 
-  int count;
+  atomic<int> count;
 
   int EstimateNumTables(MExression *MExpr);
 
-  static bool firstplan;
+  static atomic<bool> firstplan;
 };
 
 /*
@@ -265,36 +435,43 @@ it a winner's circle (cf. the Group class).
 A winner can represent these cases, if Done is true:
 (1) If MPlan is not nullptr:
         *MPlan is the cheapest possible plan in this group with PhysProp.
-        *MPlan has cost *Cost.  This derives from a successful search.
-(2) If MPlan is nullptr, and Cost is not nullptr:
-        All possible plans in this group with PhysProp cost more than *Cost.
-        This derives from a search which fails because of cost.
-(3) If MPlan is nullptr, and Cost is nullptr:
-        There can be no plan in this group with PhysProp
-        (Should never happen if we have enforcers)
-        (also should not happen because winners are initialized with context's costs)
+        *MPlan has cost Cost.  This derives from a successful search.
+(2) If MPlan is nullptr:
+        All possible plans in this group with PhysProp cost more than Cost,
+        which may be infinite.  This derives from a search which fails because of cost.
 
 While the physical mexpressions of a group are being costed (i.e. Done=false),
 the cheapest plan yet found, and its cost, are stored in a winner.
+
+Tasks on several threads read winners while a search improves on them, so a
+winner does not change once it is in the winner's circle.  The search puts a
+new winner in its place instead.  Tasks may still hold the old one (e.g. as the
+cost of an input), so it is kept, linked from its replacement, and deleted with it.
+
+MPlan is the physical mexpr in the group, which lives as long as the search space.
 */
 
 class WINNER {
  private:
   MExression *MPlan;
   PHYS_PROP *PhysProp;  // PhysProp and Cost typically represent the context of
-  Cost *cost;           // the most recent search which generated this winner.
+  Cost cost;            // the most recent search which generated this winner.
 
   bool Done;  // Is this a real winner; is the current search complete?
+
+  WINNER *Prev;  // the winner this one replaced
+
+  friend class Group;
+
  public:
-  WINNER(MExression *, PHYS_PROP *, Cost *, bool done = false);
-  ~WINNER() {
-    delete MPlan;
-    delete cost;
-  };
+  WINNER(MExression *, PHYS_PROP *, const Cost &, bool done = false, WINNER *Prev = nullptr);
+  ~WINNER();
+
+  static void *operator new(size_t size);
+  static void operator delete(void *p, size_t size);
 
   inline MExression *GetMPlan() { return (MPlan); };
   inline PHYS_PROP *GetPhysProp() { return (PhysProp); };
-  inline Cost *GetCost() { return (cost); };
+  inline Cost GetCost() { return (cost); };
   inline bool GetDone() { return (Done); };
-  inline void SetDone(bool value) { Done = value; };
 };
@@ -1,30 +1,39 @@
-// stdafx.h : include file for standard system include files,
-//  or project specific include files that are used frequently, but
-//      are changed infrequently
-//	$Revision: 3 $
-
-
-#pragma once
-
-
-#include <assert.h>
-#include <math.h>
-#include "time.h"
-#include <sys/timeb.h>
-#include <iostream>
-#include <fstream>
-#include <vector>
-#include <string>
-#include <chrono>
-#include <iomanip>
-#include <unordered_map>
-
-#include "json.hpp"
-using json = nlohmann::json;
-
-using namespace std;
-
-#include "defs.h"
-#include "supp.h"
-
-
+// stdafx.h : include file for standard system include files,
+//  or project specific include files that are used frequently, but
+//      are changed infrequently
+//	$Revision: 3 $
+
+
+#pragma once
+
+
+#include <assert.h>
+#include <math.h>
+#include "time.h"
+#include <sys/timeb.h>
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <chrono>
+#include <iomanip>
+#include <unordered_map>
+#include <deque>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <map>
+#include <random>
+
+#include "json.hpp"
+using json = nlohmann::json;
+
+using namespace std;
+
+#include "defs.h"
+#include "supp.h"
+
+
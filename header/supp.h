@@ -16,26 +16,324 @@ class LOG_PROP;       // Abstract class of logical properties.
 class LOG_COLL_PROP;  // For collection types
 class LOG_ITEM_PROP;  // For items (predicates)
 class PHYS_PROP;      // Physical Properties
+class PHYS_PROP_TABLE;
 class CONT;           // Context: Conditions/Constraints on a search
 class Cost;           // Cost of a physical operator or expression
 
-// other statistics
-class OPT_STAT {
+/*
+    ============================================================
+    BIT SETS - class BIT_SET, class ATOMIC_BIT_SET
+    ============================================================
+    A set of N bits, sized at compile time and kept in 64 bit words, so the
+    compiler can unroll and vectorize the loops over the words.  BIT_VECTOR,
+    the set of rules, has one bit per RULELABELS entry.
+
+    ATOMIC_BIT_SET is a BIT_SET worker threads update concurrently: bits are
+    set one word at a time, so a reader sees each set bit, but not the bits
+    of an update all at once.
+*/
+template <int N>
+class ATOMIC_BIT_SET;
+
+template <int N>
+class BIT_SET {
+ public:
+  static const int WORDS = (N + 63) / 64;
+
+ private:
+  uint64_t Words[WORDS];
+  friend class ATOMIC_BIT_SET<N>;
+
+ public:
+  BIT_SET() : Words{} {};
+  BIT_SET(initializer_list<int> Bits) : Words{} {
+    for (int Bit : Bits) set(Bit);
+  };
+
+  inline void set(int Bit) {
+    assert(Bit >= 0 && Bit < N);
+    Words[Bit >> 6] |= (uint64_t)1 << (Bit & 63);
+  };
+  inline bool test(int Bit) const {
+    assert(Bit >= 0 && Bit < N);
+    return Words[Bit >> 6] >> (Bit & 63) & 1;
+  };
+  inline BIT_SET &operator|=(const BIT_SET &other) {
+    for (int i = 0; i < WORDS; i++) Words[i] |= other.Words[i];
+    return *this;
+  };
+  inline bool operator==(const BIT_SET &other) const {
+    for (int i = 0; i < WORDS; i++)
+      if (Words[i] != other.Words[i]) return false;
+    return true;
+  };
+};
+
+template <int N>
+class ATOMIC_BIT_SET {
+ private:
+  atomic<uint64_t> Words[BIT_SET<N>::WORDS];
+
+ public:
+  ATOMIC_BIT_SET() { reset(); };
+  ATOMIC_BIT_SET(const BIT_SET<N> &Bits) { *this = Bits; };
+
+  inline void set(int Bit) {
+    assert(Bit >= 0 && Bit < N);
+    Words[Bit >> 6].fetch_or((uint64_t)1 << (Bit & 63));
+  };
+  inline bool test(int Bit) const {
+    assert(Bit >= 0 && Bit < N);
+    return Words[Bit >> 6].load() >> (Bit & 63) & 1;
+  };
+  inline void reset() {
+    for (int i = 0; i < BIT_SET<N>::WORDS; i++) Words[i] = 0;
+  };
+
+  inline ATOMIC_BIT_SET &operator=(const BIT_SET<N> &Bits) {
+    for (int i = 0; i < BIT_SET<N>::WORDS; i++) Words[i] = Bits.Words[i];
+    return *this;
+  };
+  // keep the bits other threads are setting
+  inline ATOMIC_BIT_SET &operator|=(const BIT_SET<N> &Bits) {
+    for (int i = 0; i < BIT_SET<N>::WORDS; i++)
+      if (Bits.Words[i]) Words[i].fetch_or(Bits.Words[i]);
+    return *this;
+  };
+  BIT_SET<N> load() const {
+    BIT_SET<N> Bits;
+    for (int i = 0; i < BIT_SET<N>::WORDS; i++) Bits.Words[i] = Words[i];
+    return Bits;
+  };
+};
+
+typedef BIT_SET<R_END> BIT_VECTOR;  // a set of rules
+
+/*
+    ============================================================
+    SET OF ATTRIBUTES - class ATT_SET
+    ============================================================
+    A set of attribute ids, one bit per id.  The catalog fixes the number
+    of attributes only at run time, so the words grow with the largest id
+    set.  A schema keeps one for its attributes; key sets hold a few
+    attributes each and are copied everywhere, so they do without.
+*/
+class ATT_SET {
+ private:
+  vector<uint64_t> Words;
+
  public:
-  int TotalMExpr;
-  int DupMExpr;
-  int HashedMExpr;
-  int MaxBucket;
-  int FiredRule;
+  inline void set(int AttId) {
+    assert(AttId >= 0);
+    if ((AttId >> 6) >= Words.size()) Words.resize((AttId >> 6) + 1, 0);
+    Words[AttId >> 6] |= (uint64_t)1 << (AttId & 63);
+  };
+  inline bool test(int AttId) const {
+    return AttId >= 0 && (AttId >> 6) < Words.size() && (Words[AttId >> 6] >> (AttId & 63) & 1);
+  };
+  inline ATT_SET &operator|=(const ATT_SET &other) {
+    if (other.Words.size() > Words.size()) Words.resize(other.Words.size(), 0);
+    for (int i = 0; i < other.Words.size(); i++) Words[i] |= other.Words[i];
+    return *this;
+  };
+  inline void clear() { Words.clear(); };
+};
 
-  OPT_STAT() : TotalMExpr(0), DupMExpr(0), FiredRule(0), HashedMExpr(0), MaxBucket(0){};
+/*
+    ============================================================
+    SHARED ARRAY - class SHARED_ARRAY
+    ============================================================
+    An array of pointers shared by the worker threads.  Entries are kept in
+    fixed size segments which never move, so threads index the array without
+    locking while others add entries.  Adding an entry takes a lock.
+*/
+template <class T>
+class SHARED_ARRAY {
+ private:
+  static const int SEGMENT_BITS = 10;
+  static const int SEGMENT_SIZE = 1 << SEGMENT_BITS;
+  static const int MAX_SEGMENTS = 1 << 14;  // room for 16M entries
+
+  atomic<atomic<T *> *> Segments[MAX_SEGMENTS];
+  atomic<int> Size;  // one past the highest entry set
+  mutex Lock;
+
+  // the slot of entry i, allocating its segment if needed.  Called under Lock.
+  atomic<T *> &Slot(int i) {
+    assert(i >= 0 && i < MAX_SEGMENTS * SEGMENT_SIZE);
+    atomic<T *> *Segment = Segments[i >> SEGMENT_BITS];
+    if (!Segment) {
+      Segment = new atomic<T *>[SEGMENT_SIZE]();
+      Segments[i >> SEGMENT_BITS] = Segment;
+    }
+    return Segment[i & (SEGMENT_SIZE - 1)];
+  };
+
+ public:
+  SHARED_ARRAY() : Size(0) {
+    for (auto &&Segment : Segments) Segment = nullptr;
+  };
+  ~SHARED_ARRAY() { clear(); };
+
+  inline int size() { return Size; };
+
+  // entry i, nullptr if it has not been set yet
+  inline T *operator[](int i) {
+    atomic<T *> *Segment = Segments[i >> SEGMENT_BITS];
+    return Segment ? Segment[i & (SEGMENT_SIZE - 1)].load() : nullptr;
+  };
+
+  // set entry i, growing the array if needed
+  void set(int i, T *value) {
+    lock_guard<mutex> guard(Lock);
+    Slot(i) = value;
+    if (i >= Size) Size = i + 1;
+  };
+
+  // append an entry, return its index
+  int push_back(T *value) {
+    lock_guard<mutex> guard(Lock);
+    int i = Size;
+    Slot(i) = value;
+    Size = i + 1;
+    return i;
+  };
+
+  // drop all entries, the caller deletes what they point to
+  void clear() {
+    lock_guard<mutex> guard(Lock);
+    for (auto &&Segment : Segments) {
+      delete[] Segment.load();
+      Segment = nullptr;
+    }
+    Size = 0;
+  };
+};
+
+/*
+    ============================================================
+    ARENA - class ARENA
+    ============================================================
+    A bump allocator.  Objects are carved out of large chunks, which are
+    released all at once when the arena is reset or destroyed.  A deleted
+    object goes to a free list of its size and is reused by the next object
+    of that size.  An arena is used by a single thread at a time.
+*/
+class ARENA {
+ private:
+  static const int CHUNK_SIZE = 64 * 1024;
+  static const int ALIGN = 16;
+  static const int FREE_LISTS = 16;  // objects of up to FREE_LISTS * ALIGN bytes are recycled
+
+  vector<char *> Chunks;  // kept by reset(), for the next objects
+  vector<char *> Big;     // objects larger than a quarter of a chunk
+  int Cur;                // chunk being carved, -1 if none
+  char *Top;
+  char *End;
+  void *FreeList[FREE_LISTS];
+  size_t Used;  // bytes handed out since the last reset
+
+ public:
+  ARENA();
+  ~ARENA();
+
+  void *alloc(size_t size);
+  void free(void *p, size_t size);
+  // was p allocated by this arena
+  bool owns(void *p);
+  // release every object, keep the chunks
+  void reset();
+  inline size_t size() { return Used; };
+};
+
+// Objects which only live while a task performs (bindings and the expressions
+// built from them) come from the scratch arena of that task, if it has one.
+inline void *ScratchAlloc(size_t size) { return ScratchArena ? ScratchArena->alloc(size) : ::operator new(size); }
+inline void ScratchFree(void *p, size_t size) {
+  if (ScratchArena && ScratchArena->owns(p))
+    ScratchArena->free(p, size);
+  else
+    ::operator delete(p);
+}
+
+// other statistics, counted by all the worker threads
+class OPT_STAT {
+ public:
+  atomic<int> TotalMExpr;
+  atomic<int> DupMExpr;
+  atomic<int> DupSubstitute;  // substitutes of rules which were already in their group
+  atomic<int> HashedMExpr;    // lookups in the duplicate table
+  atomic<long> TotalProbe;    // slots read by those lookups
+  atomic<int> MaxProbe;
+  atomic<int> HashResize;  // shards of the duplicate table grown
+  atomic<int> MergedGroup;
+  atomic<int> FiredRule;
+  atomic<int> SkippedRule;  // rule applications given up at the deadline
+  atomic<int> EpsWinner;    // final winners taken by global epsilon pruning
+  int DPPairs;              // csg-cmp pairs joined by DPccp
+  int GooJoins;             // joins of the greedy trees
+  int RandomMoves;          // moves tried by the randomized join search
+  int HashEntries;  // mexprs and slots in the duplicate table, at the end of optimization
+  int HashSlots;
+  int LogProps;        // logical properties of the groups, and how many were shared by another group
+  int SharedLogProps;
+  int Contexts;        // contexts made for searches, how many searches shared one instead,
+  int SharedContexts;  // and the most alive at once.  Counted under CONT's lock.
+  int PeakContexts;
+
+  OPT_STAT()
+      : TotalMExpr(0),
+        DupMExpr(0),
+        DupSubstitute(0),
+        FiredRule(0),
+        SkippedRule(0),
+        EpsWinner(0),
+        DPPairs(0),
+        GooJoins(0),
+        RandomMoves(0),
+        HashedMExpr(0),
+        TotalProbe(0),
+        MaxProbe(0),
+        HashResize(0),
+        MergedGroup(0),
+        HashEntries(0),
+        HashSlots(0),
+        LogProps(0),
+        SharedLogProps(0),
+        Contexts(0),
+        SharedContexts(0),
+        PeakContexts(0){};
+
+  // count a lookup which read Probe slots of the duplicate table
+  void SeenProbe(int Probe) {
+    HashedMExpr++;
+    TotalProbe += Probe;
+    // raise MaxProbe to Probe, unless another thread has seen a longer probe
+    int Max = MaxProbe;
+    while (Max < Probe && !MaxProbe.compare_exchange_weak(Max, Probe))
+      ;
+  };
 
   string Dump() {
     string os;
     os += "Duplicate MExpr: " + to_string(DupMExpr) + "\n";
+    os += "Duplicate Substitutes: " + to_string(DupSubstitute) + "\n";
     os += "Hashed Logical MExpr: " + to_string(HashedMExpr) + "\n";
-    os += "Max Overflow Buckets: " + to_string(MaxBucket) + "\n";
+    os += "Hash Table Load Factor: " + to_string(HashSlots ? (double)HashEntries / HashSlots : 0) + " (" +
+          to_string(HashEntries) + " / " + to_string(HashSlots) + ")\n";
+    os += "Hash Table Resizes: " + to_string(HashResize) + "\n";
+    os += "Average Probe Length: " + to_string(HashedMExpr ? (double)TotalProbe / HashedMExpr : 0) + "\n";
+    os += "Max Probe Length: " + to_string(MaxProbe) + "\n";
+    os += "Merged Groups: " + to_string(MergedGroup) + "\n";
+    os += "Logical Properties: " + to_string(LogProps) + " (" + to_string(SharedLogProps) + " shared)\n";
+    os += "Contexts: " + to_string(Contexts) + " (" + to_string(SharedContexts) + " shared, " + to_string(PeakContexts) +
+          " at once)\n";
     os += "FiredRules: " + to_string(FiredRule) + "\n";
+    if (SkippedRule) os += "Skipped Rules: " + to_string(SkippedRule) + "\n";
+    if (EpsWinner) os += "Epsilon Winners: " + to_string(EpsWinner) + "\n";
+    if (DPPairs) os += "DPccp Pairs: " + to_string(DPPairs) + "\n";
+    if (GooJoins) os += "GOO Joins: " + to_string(GooJoins) + "\n";
+    if (RandomMoves) os += "Randomized Join Moves: " + to_string(RandomMoves) + "\n";
 
     return os;
   };
@@ -311,7 +609,7 @@ class Attribute {
 
   Attribute(string range_var, int *atts, int size);
 
-  Attribute(Attribute &other) : AttId(other.AttId), CuCard(other.CuCard), Min(other.Min), Max(other.Max){};
+  Attribute(const Attribute &other) : AttId(other.AttId), CuCard(other.CuCard), Min(other.Min), Max(other.Max){};
 
   ~Attribute(){};
 
@@ -336,8 +634,9 @@ class Attribute {
 
 class Schema {
  private:
-  Attribute **Attrs;  // Attributes
-  int Size;           // number of the attrs
+  Attribute *Attrs;  // Attributes, stored in place
+  int Size;          // number of the attrs
+  ATT_SET AttSet;    // ids of the attrs
 
  public:
   int *TableId;  // Base tables appearing in this schema - used for calculating Max cucards
@@ -348,14 +647,15 @@ class Schema {
   // Make space for n attrs
   Schema(int n) : Size(n) {
     assert(Size >= 0);
-    Attrs = new Attribute *[Size];
+    Attrs = new Attribute[Size];
   };
 
   Schema(Schema &other) : Size(other.Size), TableNum(other.TableNum) {
     int i;
     assert(Size >= 0);
-    Attrs = new Attribute *[Size];
-    for (i = 0; i < Size; i++) Attrs[i] = new Attribute(*(other[i]));
+    Attrs = new Attribute[Size];
+    for (i = 0; i < Size; i++) Attrs[i] = other.Attrs[i];
+    AttSet = other.AttSet;
     TableId = new int[TableNum];
     for (i = 0; i < TableNum; i++) TableId[i] = other.GetTableId(i);
   }
@@ -363,7 +663,7 @@ class Schema {
   ~Schema();
 
   // return FALSE if duplicate found
-  bool AddAttr(int Index, Attribute *attr);
+  bool AddAttr(int Index, const Attribute &attr);
 
   // return true if the attr is in the schema
   bool InSchema(int AttId);
@@ -378,7 +678,7 @@ class Schema {
   Schema *UnionSchema(Schema *other);
 
   // return the nth attr in the schema
-  inline Attribute *operator[](int n) { return Attrs[n]; }
+  inline Attribute *operator[](int n) { return &Attrs[n]; }
 
   inline int GetSize() { return Size; }
 
@@ -397,6 +697,10 @@ class Schema {
   // store the key-sets of all attributes in the schema
   KEYS_SET *AttrStore();
 
+  // same attrs, with the same statistics, from the same tables
+  bool operator==(Schema &other);
+  ub4 hash();
+
   string Dump();
   string DumpCOVE();
 
@@ -415,6 +719,10 @@ class LOG_PROP {
   LOG_PROP(){};
   virtual ~LOG_PROP(){};
 
+  // for LOG_PROP_TABLE: equal properties have equal hashes
+  virtual ub4 hash() = 0;
+  virtual bool Equal(LOG_PROP *other) = 0;
+
   virtual string Dump() = 0;
   virtual string DumpCOVE() = 0;
 };
@@ -433,6 +741,8 @@ class LOG_COLL_PROP : public LOG_PROP {
 
   KEYS_SET *CandidateKey;  // candidate key
 
+  // The foreign keys come from the catalog and never change during the
+  // search, so every property points to the catalog's copies.
   vector<FOREIGN_KEY *> FKeyList;
 
   LOG_COLL_PROP(float card, float ucard, Schema *schema, KEYS_SET *cand_keys = NULL)
@@ -449,9 +759,11 @@ class LOG_COLL_PROP : public LOG_PROP {
   ~LOG_COLL_PROP() {
     delete schema;
     delete CandidateKey;
-    for (int i = 0; i < FKeyList.size(); i++) delete FKeyList[i];
   };
 
+  ub4 hash();
+  bool Equal(LOG_PROP *other);
+
   string Dump();
   string DumpCOVE();
 };
@@ -470,6 +782,9 @@ class LOG_ITEM_PROP : public LOG_PROP {
 
   ~LOG_ITEM_PROP(){};
 
+  ub4 hash();
+  bool Equal(LOG_PROP *other);
+
   string Dump() {
     string os;
     os = "Max : " + to_string(Max) + ", Min : " + to_string(Min) + ", CuCard : " + to_string(CuCard) +
@@ -485,6 +800,32 @@ class LOG_ITEM_PROP : public LOG_PROP {
   };
 };
 
+/*
+============================================================
+LOG_PROP_TABLE: SHARED LOGICAL PROPERTIES
+============================================================
+Groups never change their logical properties once they are derived, so
+groups with equal properties share one instance.  Intern() hash-conses a
+property: it returns the equal one already in the table and deletes the new
+one, or keeps the new one.  The table owns what it holds, and releases it
+with the search space.  Workers intern concurrently, under a lock.
+*/
+class LOG_PROP_TABLE {
+ private:
+  mutex Lock;
+  unordered_multimap<ub4, LOG_PROP *> Props;
+  int Shared;  // properties given back in place of an equal new one
+
+ public:
+  LOG_PROP_TABLE() : Shared(0){};
+  ~LOG_PROP_TABLE();
+
+  LOG_PROP *Intern(LOG_PROP *Prop);
+
+  inline int size() { return Props.size(); };
+  inline int shared() { return Shared; };
+};
+
 /*
 ============================================================
 PHYS_PROP: PHYSICAL PROPERTIES
@@ -500,7 +841,16 @@ PHYS_PROP: PHYSICAL PROPERTIES
 //  can have only one physical property.  Extensions should be
 //  tedious but not too hard.
 
+// Equal properties have the same id, which the winner's circles are keyed
+// on.  The ids are those of PHYS_PROP::Table, which keeps one instance of
+// each property ever looked up, and any is always 0.
+
 class PHYS_PROP {
+ private:
+  atomic<int> Id;  // -1 until GetId() looks it up, and again when the keys change
+  static PHYS_PROP_TABLE Table;
+  friend class PHYS_PROP_TABLE;
+
  public:
   const ORDER Order;       // any, heap, sorted or hashed
   KEYS_SET *Keys;          // Keys on which sorted or hashed null if heap or any, nonnull otherwise
@@ -518,7 +868,16 @@ class PHYS_PROP {
 
   ORDER GetOrder() { return (Order); }
   KEYS_SET *GetKeysSet() { return (Keys); }
-  void SetKeysSet(KEYS_SET *NewKeys) { Keys = NewKeys; }
+  void SetKeysSet(KEYS_SET *NewKeys) {
+    Keys = NewKeys;
+    Id = -1;
+  }
+
+  // the id of this property, the same for all equal properties
+  int GetId();
+  // the instance of Table equal to this property, which is never deleted
+  PHYS_PROP *Canonical();
+  ub4 hash();
 
   // merge other phys_prop in
   void Merge(PHYS_PROP &other);
@@ -531,6 +890,24 @@ class PHYS_PROP {
   string DumpCOVE();
 };
 
+// The properties with an id, indexed by it.  Workers add to it
+// concurrently, under a lock.
+class PHYS_PROP_TABLE {
+ private:
+  mutex Lock;
+  unordered_multimap<ub4, int> Ids;
+  SHARED_ARRAY<PHYS_PROP> Props;
+
+ public:
+  PHYS_PROP_TABLE();
+  ~PHYS_PROP_TABLE();
+
+  // the id of the property equal to Prop, adding a copy of Prop if there is none
+  int Intern(PHYS_PROP *Prop);
+  inline PHYS_PROP *operator[](int Id) { return Props[Id]; };
+  inline int size() { return Props.size(); };
+};
+
 /*
     ============================================================
     Cost - cost of executing a physical operator, expression or multiexpression
@@ -539,8 +916,10 @@ Cost cannot be associated with a multiexpression, since cost is determined
 by properties desired.  For example, a SELECT will cost
 more if sorted is required.
 
-Cost value of -1 = infinite cost.  Any other negative cost
-   is considered an error.
+Cost is a value: it is copied rather than allocated, and CONT keeps its
+upper bound in an atomic<Cost>.  An infinite cost is HUGE_VAL (see
+Cost::Infinite()), so that the comparisons need no special case.  A
+negative cost is an error.
 */
 
 class Cost {
@@ -548,115 +927,55 @@ class Cost {
   double Value;  // Later this may be a base class specialized
                  // to various costs: CPU, IO, etc.
  public:
-  Cost(double Number) : Value(Number) { assert(Number == -1 || Number >= 0); };
-  Cost(Cost &other) : Value(other.Value){};
+  Cost() : Value(0){};
+  Cost(double Number) : Value(Number) { assert(Number >= 0); };
+
+  static inline Cost Infinite() { return Cost(HUGE_VAL); };
+  inline bool is_infinite() const { return Value == HUGE_VAL; };
 
-  ~Cost(){};
+  inline double GetValue() const { return Value; };
 
   // FinalCost() makes "this" equal to the total of local and input costs.
-  //  It is an error if any input is null.
   //  In a parallel environment, this may involve max.
-  void FinalCost(Cost *LocalCost, Cost **TotalInputCost, int Size);
+  void FinalCost(const Cost &LocalCost, const Cost *TotalInputCost, int Size);
 
   inline Cost &operator+=(const Cost &other) {
-    if (Value == -1 || other.Value == -1)  // -1 means Infinite
-      Value = -1;
-    else
-      Value += other.Value;
+    Value += other.Value;
+    return (*this);
+  }
 
+  // as with +=, an infinite operand makes the result infinite
+  inline Cost &operator-=(const Cost &other) {
+    Value = (is_infinite() || other.is_infinite()) ? HUGE_VAL : Value - other.Value;
     return (*this);
   }
 
   inline Cost &operator*=(double EPS) {
     assert(EPS > 0);
-
-    if (Value == -1)  // -1 means Infinite
-      Value = 0;
-    else
-      Value *= EPS;
-
+    Value *= EPS;
     return (*this);
   }
 
   inline Cost &operator/=(int arity) {
     assert(arity > 0);
-
-    if (Value == -1)  // -1 means Infinite
-      Value = 0;
-    else
-      Value /= arity;
-
+    Value /= arity;
     return (*this);
   }
 
-  inline Cost &operator-=(const Cost &other) {
-    if (Value == -1 || other.Value == -1)  // -1 means Infinite
-      Value = -1;
-    else
-      Value -= other.Value;
-
-    return (*this);
-  }
+  inline Cost operator*(double EPS) const { return Cost(*this) *= EPS; }
+  inline Cost operator/(int arity) const { return Cost(*this) /= arity; }
 
-  inline Cost &operator=(const Cost &other) {
-    this->Value = other.Value;
-    return (*this);
-  }
+  inline bool operator>=(const Cost &other) const { return Value >= other.Value; }
+  inline bool operator>(const Cost &other) const { return Value > other.Value; }
+  inline bool operator<(const Cost &other) const { return Value < other.Value; }
+  inline bool operator<=(const Cost &other) const { return Value <= other.Value; }
 
-  inline bool operator>=(const Cost &other) {
-    if (Value == -1) return (true);
-
-    if (other.Value == -1)  // -1 means Infinite
-      return (false);
-
-    return (this->Value >= other.Value);
-  }
-
-  inline Cost &operator*(double EPS) {
-    assert(EPS >= 0);
-
-    Cost *temp;
-    if (Value == -1)  // -1 means Infinite
-      temp = new Cost(0);
-    else
-      temp = new Cost(Value * EPS);
-    return (*temp);
-  }
-
-  inline Cost &operator/(int arity) {
-    assert(arity > 0);
-
-    Cost *temp;
-    if (Value == -1)  // -1 means Infinite
-      temp = new Cost(0);
-    else
-      temp = new Cost(Value / arity);
-
-    return (*temp);
-  }
-
-  inline bool operator>(const Cost &other) {
-    if (Value == -1) return (true);
-
-    if (other.Value == -1)  // -1 means Infinite
-      return (false);
-
-    return (this->Value > other.Value);
-  }
-
-  inline bool operator<(const Cost &other) {
-    if (Value == -1) return (false);
-
-    if (other.Value == -1)  // -1 means Infinite
-      return (true);
-
-    return (this->Value < other.Value);
-  }
-
-  string Dump();
+  string Dump() const;
 
 };  // class Cost
 
+static_assert(is_trivially_copyable<Cost>::value, "Cost is passed and stored by value");
+
 /*
 ============================================================
 CONTEXTs/CONSTRAINTS on a search
@@ -674,32 +993,59 @@ CONTEXTs/CONSTRAINTS on a search
 // not only to save space, but to share information about when
 // the search is done, what is the current upper bound, etc.
 
+// A context lives as long as a task uses it.  Each task holds a reference
+// to its context, and the last one to finish deletes it and gives its slot
+// in vc to the next context.  Searches of the same group for the same
+// property and bound share one context, found with Intern().  The context
+// of the whole query, context 0, is held until Clear().
+
 class CONT {
  public:
   // The vector of contexts, vc, implements sharing.  Each task which
   // creates a context  adds an entry to this vector.  Finish is true
   //  means the task is done.
-  static vector<CONT *> vc;
+  static SHARED_ARRAY<CONT> vc;
 
  private:
   PHYS_PROP *ReqdPhys;
-  Cost *UpperBd;
-  bool Finished;
+  atomic<Cost> UpperBd;  // tasks of the search read it while others lower it
+  atomic<bool> Finished;
 
- public:
-  CONT(PHYS_PROP *, Cost *Upper, bool done);
+  atomic<int> Users;  // tasks holding this context
+  int GroupID;        // the search of an interned context, -1 if it is not interned
+  Cost Requested;     // and the bound it was interned with, which UpperBd may have lowered since
 
-  ~CONT() {
-    delete UpperBd;
-    delete ReqdPhys;
-  };
+  static mutex Lock;  // guards Interned and FreeSlots
+  static unordered_multimap<size_t, int> Interned;
+  static vector<int> FreeSlots;
+  static int Live;  // contexts in vc
+
+  static size_t Key(int GroupID, PHYS_PROP *Prop, const Cost &Bound);
+  static int Add(CONT *Context);  // put Context in vc, in a free slot if there is one.  Called under Lock.
+
+ public:
+  CONT(PHYS_PROP *, Cost Upper, bool done);
+
+  ~CONT() { delete ReqdPhys; };
+
+  // the context of a search of GroupID for Prop, under Bound.  It may be
+  // shared with another search of GroupID, and is returned held by the
+  // caller, who releases it once the task using it has been created.  Takes
+  // Prop.
+  static int Intern(int GroupID, PHYS_PROP *Prop, const Cost &Bound);
+  // add a context which is not shared, such as context 0.  It is held by the caller.
+  static int Hold(CONT *Context);
+  static inline void Acquire(int ContID) { vc[ContID]->Users++; };
+  static void Release(int ContID);
+  // delete the contexts left, after a query
+  static void Clear();
 
   inline PHYS_PROP *GetPhysProp() { return (ReqdPhys); };
-  inline Cost *GetUpperBd() { return (UpperBd); };
+  inline Cost GetUpperBd() { return (UpperBd); };
   inline void SetPhysProp(PHYS_PROP *RP) { ReqdPhys = RP; };
 
   string Dump() {
-    return "Prop: " + ReqdPhys->Dump() + ", UpperBd: " + UpperBd->Dump() + ", Finished:" + to_string(Finished);
+    return "Prop: " + ReqdPhys->Dump() + ", UpperBd: " + GetUpperBd().Dump() + ", Finished:" + to_string(Finished);
   }
 
   // set the flag if the context is done, means we completed the search,
@@ -707,8 +1053,9 @@ class CONT {
   inline void done() { Finished = true; };
   inline bool is_done() { return Finished; };
 
-  //  Update bounds, when we get better ones.
-  inline void SetUpperBound(Cost &NewUB) { *UpperBd = NewUB; };
+  //  Update bounds, when we get better ones.  Tasks of the same search
+  //  may race to do so; the lowest bound wins.
+  void SetUpperBound(const Cost &NewUB);
 };
 
 /*
@@ -725,9 +1072,6 @@ int *CopyArray(int *IntArray, int Size);
 // return true if the contents of two arrays are equal
 bool EqualArray(int *array1, int *array2, int size);
 
-void bit_on(BIT_VECTOR &bit_vect, int rule_no);  // Turn this bit on
-
-bool is_bit_off(BIT_VECTOR bit_vect, int rule_no);  // Is this bit off?
 
 // need for group pruning, calculate the copy-out cost of the expr
 double TouchCopyCost(LOG_COLL_PROP *LogProp);
@@ -739,21 +1083,48 @@ double FetchingCost(LOG_COLL_PROP *LogProp);
 ub4 lookup2(string k, ub4 length, ub4 initval);
 ub4 lookup2(ub4 k, ub4 initval);
 
+/*
+   ============================================================
+   SYMBOL_TABLE
+   ============================================================
+   Interns the names of the catalog: the first lookup of a name gives it
+   the next id, and later ones find that id by hashing.  Id 0 is the empty
+   name.  Names are never moved, so the hash table keys are views of them.
+*/
+class SYMBOL_TABLE {
+ private:
+  deque<string> Names;  // by id
+  unordered_map<string_view, int> Ids;
+
+ public:
+  SYMBOL_TABLE() { clear(); };
+
+  // id of Name, added if new
+  int intern(const string &Name);
+  inline const string &name(int Id) {
+    assert(Id >= 0 && Id < Names.size());
+    return Names[Id];
+  };
+  inline int size() { return Names.size(); };
+  // forget all names but the empty one
+  void clear();
+};
+
 // Get the names from ids
-string GetCollName(int CollId);
-string GetAttName(int AttId);
-string GetIndName(int IndId);
-string GetBitIndName(int BitIndId);
+const string &GetCollName(int CollId);
+const string &GetAttName(int AttId);
+const string &GetIndName(int IndId);
+const string &GetBitIndName(int BitIndId);
 // Transform A.B into B
 string TruncName(string AttId);
 
-// Get the Ids from names
+// Get the Ids from names, adding the names if new
 int GetCollId(int AttId);
-int GetCollId(string CollName);
-int GetAttId(string CollName, string AttName);
-int GetAttId(string Name);
-int GetIndId(string CollName, string IndName);
-int GetBitIndId(string CollName, string IndName);
+int GetCollId(const string &CollName);
+int GetAttId(const string &CollName, const string &AttName);
+int GetAttId(const string &Name);
+int GetIndId(const string &CollName, const string &IndName);
+int GetBitIndId(const string &CollName, const string &IndName);
 
 // convert string to Domain type
 DOM_TYPE atoDomain(char *p);
@@ -9,7 +9,7 @@ typedef struct MOVE {
 
 typedef struct AFTERS {
   MExression *m_expr;
-  Cost *cost;
+  Cost cost;
 } AFTERS;
 
 /*
@@ -26,8 +26,15 @@ typedef struct AFTERS {
 
         OptimizerTask is an abstract class.  Its subclasses are specific tasks.
 
+        A task and the tasks it schedules form a frame.  The serial engine
+        relied on LIFO order: the last task of a frame marked the group's
+        winner done.  Now the TaskScheduler tracks frames explicitly, calls
+        finish() once a task and every task it scheduled have completed, and
+        then destroys the task.  Tasks must never delete themselves.
 
-        Tasks must destroy themselves when done!
+        Tasks are made and destroyed by the million.  Their memory comes from
+        free lists of the thread, carved from chunks kept until the program
+        ends, so a task made on one worker may be destroyed on another.
 */
 
 class OptimizerTask {
@@ -36,47 +43,96 @@ class OptimizerTask {
   int ParentTaskNo;  // The task which created me
 
  public:
-  OptimizerTask(int ContextID, int ParentTaskNo) : ContextID(ContextID), ParentTaskNo(ParentTaskNo){};
-  virtual ~OptimizerTask(){};
+  // a task holds its context while it lives
+  OptimizerTask(int ContextID, int ParentTaskNo) : ContextID(ContextID), ParentTaskNo(ParentTaskNo) {
+    CONT::Acquire(ContextID);
+  };
+  virtual ~OptimizerTask() { CONT::Release(ContextID); };
+
+  static void *operator new(size_t size);
+  static void operator delete(void *p, size_t size);
+
   virtual string Dump() = 0;
   virtual void perform() = 0;
+  // called once this task and all the tasks it scheduled are done
+  virtual void finish(){};
+
+ private:
+  friend class TaskScheduler;
+
+  OptimizerTask *Parent = nullptr;     // the task whose frame I belong to
+  OptimizerTask *Successor = nullptr;  // a task which may not start before I finish
+  atomic<int> Pending{0};              // unfinished children, prerequisites and awaited searches
+  bool Resume = false;                 // perform me again when Pending drops to zero
 };
 
-class OptimizerTaskStack {
+/*
+        ============================================================
+        TaskScheduler
+        ============================================================
+        Runs optimizer tasks on a number of worker threads.  Each worker owns a
+        deque of runnable tasks: it pushes and pops at the back (LIFO, like the
+        old task stack) and idle workers steal from the front of other workers'
+        deques.  With a single worker the tasks run in exactly the order of the
+        serial engine.
+
+        A task may
+          - schedule children with push(); its frame completes when they do,
+          - schedule a task which may only start after some of its siblings
+            have finished (an ApplyRuleTask waits for its ExploreGroupTasks),
+          - suspend() itself, to be performed again when its children are done
+            (OptimizeInputTask returning from the search of an input group),
+          - wait() on a search another worker is running in the memo (winner
+            or exploration in progress) and be performed again when it's done.
+
+        Tasks perform concurrently; the search space guards its own state (see
+        SearchSpace and Group).  Groups found to be equivalent are merged while
+        every worker is stopped between tasks.
+*/
+
+class TaskScheduler {
  private:
-  vector<OptimizerTask *> task_stack_;
+  struct TaskDeque {
+    mutex Lock;
+    deque<OptimizerTask *> Tasks;
+  };
+  vector<TaskDeque *> Workers;
+  atomic<int> Live{0};  // tasks scheduled and not yet finished
+
+  // workers stopped while the queued groups are merged
+  mutex StopLock;
+  condition_variable StopCond;
+  int Stopped = 0;
+  int StopRound = 0;
+
+  void work(int WorkerId);
+  void stop();
+  OptimizerTask *next(int WorkerId);
+  void execute(OptimizerTask *task);
+  void enqueue(OptimizerTask *task);
+  void release(OptimizerTask *task);
 
  public:
-  ~OptimizerTaskStack() {
-    while (!empty()) delete pop();
-  };
+  ~TaskScheduler();
 
-  bool empty() { return task_stack_.empty(); };
-  void push(OptimizerTask *task) {
-    task_stack_.push_back(task);
-    if (COVETrace) OutputCOVE << "PushTaskList {" << task->Dump() << "}" << endl;
-  };
-  OptimizerTask *pop() {
-    auto task = task_stack_.back();
-    task_stack_.pop_back();
-    if (COVETrace) OutputCOVE << "PopTaskList  {" << task->Dump() << "}" << endl;
-    return task;
-  };
+  // run task and all the tasks it schedules on Threads workers, return when all are done
+  void run(OptimizerTask *task, int Threads);
 
-  string Dump() {
-    string os;
-    if (empty())
-      os = "Task Stack is empty!!";
-    else {
-      int count1 = task_stack_.size() - 5;
-      int count = 0;
-      for (auto &&task : task_stack_) {
-        if (count >= count1) os += "    task: " + to_string(count) + "   " + task->Dump() + "\n";
-        count++;
-      }
-    }
-    return os;
-  };
+  // schedule a child of the running task
+  void push(OptimizerTask *task);
+  // schedule a child of the running task which starts once every task in prereqs has finished.
+  // The prerequisites must be pushed after this call.
+  void push(OptimizerTask *task, const vector<OptimizerTask *> &prereqs);
+  // perform the running task again once the tasks it has scheduled are done
+  void suspend(OptimizerTask *task);
+  // perform the running task again once the search owning waiters wakes them up
+  void wait(OptimizerTask *task, vector<OptimizerTask *> &waiters);
+  void wake(vector<OptimizerTask *> &waiters);
+
+  // index of the worker running on this thread, 0 outside run()
+  static int worker();
+
+  string Dump();
 };
 
 /*
@@ -114,13 +170,15 @@ class OptimizerTaskStack {
 class OptimizeGroupTask : public OptimizerTask {
  private:
   Group *group_;
-  bool Last;
+  bool Searching;  // did this task begin the search for its context's property
 
  public:
-  OptimizeGroupTask(Group *group, int ContextID, int parent_task_no, bool last = true)
-      : OptimizerTask(ContextID, parent_task_no), group_(group), Last(last){};
+  OptimizeGroupTask(Group *group, int ContextID, int parent_task_no)
+      : OptimizerTask(ContextID, parent_task_no), group_(group), Searching(false){};
 
   void perform();
+  // mark the winner done and the group optimized
+  void finish();
 
   string Dump();
 };
@@ -156,12 +214,14 @@ class OptimizeGroupTask : public OptimizerTask {
 class ExploreGroupTask : public OptimizerTask {
  private:
   Group *group_;
-  bool Last;  // is it the last task in this group
+  bool Exploring;  // did this task begin the exploration of the group
  public:
-  ExploreGroupTask(Group *group, int ContextID, int parentTaskNo, bool last)
-      : OptimizerTask(ContextID, parentTaskNo), group_(group), Last(last){};
+  ExploreGroupTask(Group *group, int ContextID, int parentTaskNo)
+      : OptimizerTask(ContextID, parentTaskNo), group_(group), Exploring(false){};
 
   void perform();
+  // mark the group explored
+  void finish();
 
   string Dump();
 };
@@ -179,31 +239,9 @@ class OptimizeExprTask : public OptimizerTask {
  private:
   MExression *MExpr;   // Which expression to optimize
   const bool explore;  // if this task is for exploring  Should not happen - see ExploreGroupTask
-  bool Last;           // if this task is the last task for the group
 
  public:
-  OptimizeExprTask(MExression *mexpr, bool explore, int ContextID, int parent_task_no, bool last = false);
-
-  ~OptimizeExprTask() {
-    if (Last) {
-      Group *group = Ssp->GetGroup(MExpr->GetGrpID());
-      if (!explore) {
-        CONT *LocalCont = CONT::vc[ContextID];
-        // What prop is required of
-        PHYS_PROP *LocalReqdProp = LocalCont->GetPhysProp();
-        WINNER *Winner = group->GetWinner(LocalReqdProp);
-
-        // mark the winner as done
-        if (Winner) assert(!Winner->GetDone());
-
-        Winner->SetDone(true);
-        // this's still the last applied rule in the group,
-        // so mark the group with completed optimizing
-        group->set_optimized(true);
-      } else
-        group->set_explored(true);
-    }
-  };
+  OptimizeExprTask(MExression *mexpr, bool explore, int ContextID, int parent_task_no);
 
   string Dump();
 
@@ -225,8 +263,8 @@ class OptimizeExprTask : public OptimizerTask {
      Member data InputNo, initially 0, indicates which input has been
      costed.  This task is unique in that it does not terminate after
      scheduling other tasks.  If the current input needs to be optimized,
-     it first pushes itself onto the stack, then it schedules
-     the optimization of the current input.  If and when inputs are all
+     it suspends itself, then it schedules the optimization of the current
+     input; the scheduler performs it again when that search is done.  If and when inputs are all
      costed, it calculates the cost of the entire physical expression.
  */
 
@@ -236,22 +274,21 @@ class OptimizeInputTask : public OptimizerTask {
   int arity;
   int InputNo;      // input currently being or about to be optimized, initially 0
   int PrevInputNo;  // keep track of the previous optimized input no
-  Cost *LocalCost;  // the local cost of the mexpr
-  bool Last;        // if this task is the last task for the group
+  Cost LocalCost;   // the local cost of the mexpr
   int ContNo;       // keep track of number of contexts
 
   // Costs and properties of input winners and groups.  Computed incrementally
-  //  by this method.
-  Cost **InputCost;
+  //  by this method.  Inline for arities up to INLINE_ARITY.
+  Cost *InputCost;
   LOG_PROP **InputLogProp;
+  Cost InlineCost[INLINE_ARITY];
+  LOG_PROP *InlineLogProp[INLINE_ARITY];
 
  public:
-  OptimizeInputTask(MExression *MExpr, int ContextID, int ParentTaskNo, bool last = false, int ContNo = 0);
+  OptimizeInputTask(MExression *MExpr, int ContextID, int ParentTaskNo, int ContNo = 0);
 
   ~OptimizeInputTask();
 
-  // return the new upper bd for the input
-  Cost *NewUpperBd(Cost *OldUpperBd, int input);
   void perform();
 
   string Dump();
@@ -269,11 +306,8 @@ class ApplyRuleTask : public OptimizerTask {
   Rule *rule;          // rule to apply
   MExression *MExpr;   // root of expr. before rule
   const bool explore;  // if this task is for exploring
-  bool Last;           // if this task is the last task for the group
  public:
-  ApplyRuleTask(Rule *rule, MExression *mexpr, bool explore, int ContextID, int parent_task_no, bool last = false);
-
-  ~ApplyRuleTask();
+  ApplyRuleTask(Rule *rule, MExression *mexpr, bool explore, int ContextID, int parent_task_no);
 
   void perform();
 